@@ -3,6 +3,12 @@
 
 #include <SDL2/SDL.h> // For SDL...
 #include <cstdlib> // For abs() function
+#ifdef SDL_PROFILER
+    #include "SDL_profiler.h" // For timing zones. Only needed (with SDL_wrapper on the include path) when profiling
+#endif
+#ifndef SDL_PROFILE_ZONE
+    #define SDL_PROFILE_ZONE(name) // Keeps this header standalone without SDL_profiler.h
+#endif
 
 /*
 This file allows the modification of a texture passed through it to more closely mimic a CRT monitor.
@@ -58,6 +64,7 @@ namespace CRT
         // "Bends" the source texture according to CRT things and renders to the full size of renderer
         // FUTURE add source and destination rects?
         /// TAKES FOREVER...... FUTURE: Store all the bend pixel amounts as points in a massive vector? Might improve speed at cost of like 3MB of memory...
+        SDL_PROFILE_ZONE("CRT::renderBend");
         SDL_DestroyTexture(lastBentTexture);
         lastBentTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, WIDTH, HEIGHT);
         SDL_SetRenderTarget(renderer, lastBentTexture);
@@ -142,6 +149,7 @@ namespace CRT
         // Applies subtle chromatic aberration to a texture (one blue pixel left, one red pixel right)
         // Returns the new texture
         // If destructive, also destroys the old source texture
+        SDL_PROFILE_ZONE("CRT::chromaticAberration");
 
         // Make a rect of the needed size (+2 pixel width, 1 for blue and 1 for red)
         SDL_Rect rect = {0, 0, 0, 0};
@@ -179,6 +187,7 @@ namespace CRT
 
     SDL_Texture* addScanLines(SDL_Renderer* renderer, SDL_Texture* sourceTexture, int scanSpacing, bool destructive = false)
     {
+        SDL_PROFILE_ZONE("CRT::addScanLines");
         // Duplicate the passed texture
         SDL_Rect rect = {0, 0, 0, 0};
         SDL_QueryTexture(sourceTexture, NULL, NULL, &rect.w, &rect.h);
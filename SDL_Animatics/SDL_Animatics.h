@@ -2,6 +2,11 @@
 
 #include <SDL2/SDL.h>
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional> // For AnimaticWrapper::step
+#include <cmath>
+#include <unordered_map> // For AnimaticWrapper's spatial grid
 
 #include "SDL_wrapper.h"
 
@@ -21,58 +26,159 @@ enum AnimationType
     ANIMATION_SPRITESHEET,  // Animates the texture from a spritesheet
     ANIMATION_MOVE,         // Moves the rect from one location to another smoothly
     ANIMATION_SCALE,        // Scales the rect smoothly
-    ANIMATION_FADE          // Fades the texture completely in or completely out
+    ANIMATION_FADE,         // Fades the texture completely in or completely out
+    ANIMATION_TRACK,        // Plays a KeyframeTrack on the position, size, or alpha
+    ANIMATION_PATH          // Moves the rect along a MotionPath at a steady speed
+};
+
+enum Easing                 // How a timed animation (or a keyframe) gets from start to end. See anim_ease
+{
+    EASE_LINEAR,
+    EASE_IN_QUAD,
+    EASE_OUT_QUAD,
+    EASE_IN_OUT_QUAD,
+    EASE_IN_CUBIC,
+    EASE_OUT_CUBIC,
+    EASE_IN_OUT_CUBIC,
+    EASE_IN_BACK,           // Pulls back a little before going
+    EASE_OUT_BACK,          // Overshoots a little before settling
+    EASE_IN_OUT_BACK,
+    EASE_IN_BOUNCE,
+    EASE_OUT_BOUNCE,        // Bounces to a stop at the end
+    EASE_IN_OUT_BOUNCE,
+    EASING_COUNT            // How many are built in. anim_bezier_easing() adds more after these
+};
+
+enum TrackProperty          // What a KeyframeTrack animates
+{
+    TRACK_POSITION,
+    TRACK_SIZE,
+    TRACK_ALPHA
+};
+
+struct Keyframe {
+    float time;             // Milliseconds from the start of the track
+    vec2 value;             // Position or size. Alpha tracks use x, in range [0.0, 1.0]
+    int easing;             // How the track gets from this keyframe to the next
+};
+
+struct KeyframeTrack {       // A path through any number of keyframes. One track can be played by any number of animations at once
+    TrackProperty property = TRACK_POSITION;
+    std::vector<Keyframe> keys; // In time order
+    KeyframeTrack(TrackProperty Property = TRACK_POSITION) : property(Property) {}
+    KeyframeTrack& add(float time, vec2 value, int easing = EASE_LINEAR) {keys.push_back({time, value, easing}); return *this;}
+    KeyframeTrack& add(float time, float alpha, int easing = EASE_LINEAR) {return add(time, {alpha, 0.0}, easing);}
+    float length() const {return keys.empty() ? 0.0 : keys.back().time;} // Milliseconds until the last keyframe
+};
+
+struct MotionPath {          // A curve resampled evenly by distance (arc length), so going along it at a steady speed is a lookup and a lerp. Make one with anim_path_*
+    std::vector<vec2> samples; // Points spacing apart along the curve, first to last
+    float spacing = 1.0;    // Distance between samples
+    float length = 0.0;     // Total distance along the path
+    vec2 at(float distance) const; // Where the path is distance along it (clamped to the ends)
+    vec2 atFraction(float t) const {return at(t * length);} // Where the path is t of the way along it, t in range [0.0, 1.0]
 };
 
 struct Animation {           // A collection of data about any animation
     AnimationType type = ANIMATION_NONE; // The type of this animation
     bool complete = false; // Whether or not this animation is complete
     bool queued = false; // If true, will wait until this animation is fully complete to start next animation in chain
+    bool timed = false; // If true, the animation runs over duration (milliseconds of elapsed time) instead of a fixed amount per tick
+    float duration = 0.0; // Timed: how long the whole animation takes in milliseconds (for spritesheets, how long each frame shows)
+    float elapsed = 0.0; // Timed: milliseconds played so far (for spritesheets, of the current frame)
+    int easing = EASE_LINEAR; // Timed moves, scales and fades: how progress is shaped (an Easing, or an id from anim_bezier_easing)
     union {
         struct {                    // SpriteSheet
-            SDL_Texture* sheet;     // Pointer to the entire spritesheet texture. NOTE assumes texture is arranged horizontally
-            SDL_Rect frameRect;     // Rect containing current texture of spritesheet. NOTE this width MUST be the exact spacing between frames as well
+            SDL_Texture* sheet;     // Pointer to the entire spritesheet texture (or atlas page)
+            SDL_Rect frameRect;     // Rect containing current texture of spritesheet. NOTE this width and height MUST be the exact spacing between frames as well
+            SDL_Point origin;       // Top left of the first frame. Not 0, 0 when the sheet is packed into an atlas
+            int columns;            // Frames per row. Frames go left to right, then top to bottom (a horizontal strip is one row)
             uint8_t ticksPerFrame;  // How many ticks to keep any given animation frame
             uint8_t currentTicks;   // Used as incrementor to keep track of ticks
             int currentFrame;       // Used to keep track of the current frame
             int totalFrames;        // The number of frames of the animation
             bool loops;             // Whether or not the animation loops forever or will complete
+            bool direct;            // If true, the Animatic draws straight from the sheet through its source rect instead of having each frame copied into its texture
         };
         struct {                    // Move
             vec2 currentPos;        // The detailed position of the current rect
             vec2 targetPos;         // Where the rect is trying to move to
             vec2 deltaPos;          // How far the rect will move in each direction each update
+            vec2 startPos;          // Timed: where the move started
         };
         struct {                    // Scale
             vec2 currentScale;      // The current, detailed x,y size of the rect
             vec2 targetScale;       // The scale the animation is trying to reach
             vec2 deltaScale;        // How much the scale changes in x and y each tick
+            vec2 startScale;        // Timed: the scale the animation started from
         };
         struct {                    // Fade
             float currentFade;      // The current alpha value of the fade
             float deltaFade;        // How much this fade changes every tick
+            float startFade;        // Timed: the alpha the fade started from
+            float targetFade;       // Timed: the alpha the fade ends on
+        };
+        struct {                    // Track
+            const KeyframeTrack* track; // The keyframes to play. Not copied, so the track must outlive the animation
+            int currentKey;         // The keyframe last passed, so finding the next one doesn't search the whole track
+            bool trackLoops;        // Whether the track starts over instead of completing
+        };
+        struct {                    // Path
+            const MotionPath* path; // The path to follow. Not copied, so the path must outlive the animation
+            bool pathLoops;         // Whether it starts over from the beginning instead of completing
         };
     };
 };
 
-Animation anim_spritesheet(SDL_Texture* spritesheet, int framewidth, int frameheight, uint8_t ticksPerFrame, bool loops, bool queued = false)
+struct SheetRegion {         // Where a spritesheet's frames are, whether that's a whole texture or part of a SpriteAtlas page
+    SDL_Texture* texture = nullptr;
+    SDL_Rect area = {0, 0, 0, 0}; // The part of texture holding the frames
+    int frameWidth = 0;
+    int frameHeight = 0;
+    int columns = 1;        // Frames per row of area, row-major
+    int frames = 0;
+};
+
+Animation anim_spritesheet_grid(SDL_Texture* spritesheet, int framewidth, int frameheight, int columns, int totalFrames, uint8_t ticksPerFrame, bool loops, bool queued = false, bool direct = false)
 {
-    // Makes and returns a spritesheet anim struct
+    // Makes and returns a spritesheet anim struct for a grid of frames, read left to right and then top to bottom
+    // With direct, changing frames only moves the Animatic's source rect (no render target switches), so any number of sprites can share one sheet
+    // NOTE a fade on a direct Animatic fades the whole sheet (and so every sprite drawing from it)
     Animation d;
     d.type = ANIMATION_SPRITESHEET;
     d.sheet = spritesheet;
     d.frameRect = {0, 0, framewidth, frameheight};
+    d.origin = {0, 0};
+    d.columns = std::max(1, columns);
     d.ticksPerFrame = ticksPerFrame;
     d.currentTicks = 0;
     d.currentFrame = 0;
-    int sheetWidth = 0;
-    SDL_QueryTexture(spritesheet, nullptr, nullptr, &sheetWidth, nullptr);
-    d.totalFrames = sheetWidth / framewidth;
+    d.totalFrames = std::max(1, totalFrames);
     d.loops = loops;
+    d.direct = direct;
     d.queued = queued;
     return d;
 }
 
+Animation anim_spritesheet(SDL_Texture* spritesheet, int framewidth, int frameheight, uint8_t ticksPerFrame, bool loops, bool queued = false, bool direct = false)
+{
+    // Makes and returns a spritesheet anim struct for a horizontal strip, using every frame that fits in the texture
+    int sheetWidth = 0;
+    SDL_QueryTexture(spritesheet, nullptr, nullptr, &sheetWidth, nullptr);
+    int totalFrames = sheetWidth / framewidth;
+    return anim_spritesheet_grid(spritesheet, framewidth, frameheight, totalFrames, totalFrames, ticksPerFrame, loops, queued, direct);
+}
+
+Animation anim_spritesheet(const SheetRegion& region, uint8_t ticksPerFrame, bool loops, bool queued = false, bool direct = true)
+{
+    // Makes and returns a spritesheet anim struct for a sheet packed by a SpriteAtlas. Direct by default, since the page is shared anyway
+    Animation d = anim_spritesheet_grid(region.texture, region.frameWidth, region.frameHeight, region.columns, region.frames, ticksPerFrame, loops, queued, direct);
+    d.origin = {region.area.x, region.area.y};
+    d.frameRect.x = region.area.x;
+    d.frameRect.y = region.area.y;
+    return d;
+}
+
 Animation anim_move(vec2 startPos, vec2 targetPos, float fractionPerTick, bool queued = false)
 {
     // Makes and returns a move anim struct
@@ -110,6 +216,414 @@ Animation anim_fade(float startAlpha, float deltaAlpha, bool queued = false)
     return d;
 }
 
+Animation anim_spritesheet_timed(SDL_Texture* spritesheet, int framewidth, int frameheight, float millisecondsPerFrame, bool loops, bool queued = false, bool direct = false)
+{
+    // Makes and returns a spritesheet anim struct that changes frames by elapsed time instead of ticks
+    Animation d = anim_spritesheet(spritesheet, framewidth, frameheight, 1, loops, queued, direct);
+    d.timed = true;
+    d.duration = millisecondsPerFrame;
+    return d;
+}
+
+Animation anim_spritesheet_timed(const SheetRegion& region, float millisecondsPerFrame, bool loops, bool queued = false, bool direct = true)
+{
+    // Makes and returns a timed spritesheet anim struct for a sheet packed by a SpriteAtlas
+    Animation d = anim_spritesheet(region, 1, loops, queued, direct);
+    d.timed = true;
+    d.duration = millisecondsPerFrame;
+    return d;
+}
+
+Animation anim_move_timed(vec2 startPos, vec2 targetPos, float milliseconds, bool queued = false, int easing = EASE_LINEAR)
+{
+    // Makes and returns a move anim struct that reaches targetPos after the given time, however often it is updated
+    Animation d = anim_move(startPos, targetPos, 0.0, queued);
+    d.timed = true;
+    d.duration = milliseconds;
+    d.startPos = startPos;
+    d.easing = easing;
+    return d;
+}
+
+Animation anim_scale_timed(vec2 startDimensions, vec2 targetDimensions, float milliseconds, bool queued = false, int easing = EASE_LINEAR)
+{
+    // Makes and returns a scale anim struct that reaches targetDimensions after the given time
+    Animation d = anim_scale(startDimensions, targetDimensions, 0.0, queued);
+    d.timed = true;
+    d.duration = milliseconds;
+    d.startScale = startDimensions;
+    d.easing = easing;
+    return d;
+}
+
+Animation anim_fade_timed(float startAlpha, float targetAlpha, float milliseconds, bool queued = false, int easing = EASE_LINEAR)
+{
+    // Makes and returns a fade anim struct that reaches targetAlpha after the given time. Alphas are in range [0.0, 1.0] like anim_fade
+    Animation d = anim_fade(startAlpha, 0.0, queued);
+    d.timed = true;
+    d.duration = milliseconds;
+    d.startFade = startAlpha * 255.0;
+    d.targetFade = targetAlpha * 255.0;
+    d.easing = easing;
+    return d;
+}
+
+Animation anim_track(const KeyframeTrack& track, bool loops = false, bool queued = false)
+{
+    // Makes and returns an anim struct that plays a KeyframeTrack. The track isn't copied, so keep it around (and unchanged) while it plays
+    Animation d;
+    d.type = ANIMATION_TRACK;
+    d.timed = true;
+    d.duration = track.length();
+    d.track = &track;
+    d.currentKey = 0;
+    d.trackLoops = loops;
+    d.queued = queued;
+    return d;
+}
+
+Animation anim_path(const MotionPath& path, float milliseconds, bool loops = false, bool queued = false, int easing = EASE_LINEAR)
+{
+    // Makes and returns an anim struct that moves the rect's top left along a path in the given time. The easing shapes the speed along it
+    // The path isn't copied, so any number of animations can share one. Keep it around (and unchanged) while they play
+    Animation d;
+    d.type = ANIMATION_PATH;
+    d.timed = true;
+    d.duration = milliseconds;
+    d.path = &path;
+    d.pathLoops = loops;
+    d.queued = queued;
+    d.easing = easing;
+    return d;
+}
+
+vec2 anim_lerp(vec2 start, vec2 end, float t)
+{
+    // Returns the point t of the way from start to end. Exactly end at 1.0. Eased t can go a bit outside [0.0, 1.0], which overshoots
+    if (t == 1.0) {return end;}
+    return {start.x + (end.x - start.x) * t, start.y + (end.y - start.y) * t};
+}
+
+float anim_lerp(float start, float end, float t)
+{
+    // Returns the value t of the way from start to end. Exactly end at 1.0
+    if (t == 1.0) {return end;}
+    return start + (end - start) * t;
+}
+
+const int EASING_SAMPLES = 256; // Points in each easing's lookup table. anim_ease interpolates between them
+
+struct EasingTable {
+    float value[EASING_SAMPLES + 1]; // The eased value at i / EASING_SAMPLES
+};
+
+float anim_easing_formula(int easing, float t)
+{
+    // The exact curve of a built-in easing, used to fill its table
+    const float back = 1.70158; // The usual overshoot (about 10%)
+    const float backInOut = back * 1.525;
+    switch (easing) {
+    case EASE_IN_QUAD: return t * t;
+    case EASE_OUT_QUAD: return 1.0 - (1.0 - t) * (1.0 - t);
+    case EASE_IN_OUT_QUAD: return (t < 0.5) ? 2.0 * t * t : 1.0 - 2.0 * (1.0 - t) * (1.0 - t);
+    case EASE_IN_CUBIC: return t * t * t;
+    case EASE_OUT_CUBIC: return 1.0 - (1.0 - t) * (1.0 - t) * (1.0 - t);
+    case EASE_IN_OUT_CUBIC: return (t < 0.5) ? 4.0 * t * t * t : 1.0 - 4.0 * (1.0 - t) * (1.0 - t) * (1.0 - t);
+    case EASE_IN_BACK: return t * t * ((back + 1.0) * t - back);
+    case EASE_OUT_BACK: return 1.0 - anim_easing_formula(EASE_IN_BACK, 1.0 - t);
+    case EASE_IN_OUT_BACK:
+        t *= 2.0;
+        if (t < 1.0) {return t * t * ((backInOut + 1.0) * t - backInOut) / 2.0;}
+        t -= 2.0;
+        return (t * t * ((backInOut + 1.0) * t + backInOut) + 2.0) / 2.0;
+    case EASE_OUT_BOUNCE:
+        if (t < 1.0 / 2.75) {return 7.5625 * t * t;}
+        if (t < 2.0 / 2.75) {t -= 1.5 / 2.75; return 7.5625 * t * t + 0.75;}
+        if (t < 2.5 / 2.75) {t -= 2.25 / 2.75; return 7.5625 * t * t + 0.9375;}
+        t -= 2.625 / 2.75;
+        return 7.5625 * t * t + 0.984375;
+    case EASE_IN_BOUNCE: return 1.0 - anim_easing_formula(EASE_OUT_BOUNCE, 1.0 - t);
+    case EASE_IN_OUT_BOUNCE:
+        if (t < 0.5) {return (1.0 - anim_easing_formula(EASE_OUT_BOUNCE, 1.0 - 2.0 * t)) / 2.0;}
+        return (1.0 + anim_easing_formula(EASE_OUT_BOUNCE, 2.0 * t - 1.0)) / 2.0;
+    default: return t;
+    }
+}
+
+std::vector<EasingTable> anim_build_easing_tables()
+{
+    // Samples every built-in easing. The ends are set exactly so eased animations still land on their targets
+    std::vector<EasingTable> tables(EASING_COUNT);
+    for (int easing = 0; easing < EASING_COUNT; easing++)
+    {
+        for (int i = 0; i <= EASING_SAMPLES; i++) {tables[easing].value[i] = anim_easing_formula(easing, (float)i / EASING_SAMPLES);}
+        tables[easing].value[0] = 0.0;
+        tables[easing].value[EASING_SAMPLES] = 1.0;
+    }
+    return tables;
+}
+
+std::vector<EasingTable>& anim_easing_tables()
+{
+    // Every easing's lookup table, indexed by Easing (or anim_bezier_easing id). Built once, on first use
+    static std::vector<EasingTable> tables = anim_build_easing_tables();
+    return tables;
+}
+
+int anim_bezier_easing(float x1, float y1, float x2, float y2)
+{
+    // Adds a cubic Bezier easing from (0, 0) to (1, 1) with control points (x1, y1) and (x2, y2), like CSS's cubic-bezier(), returning its id
+    // x1 and x2 are clamped to [0.0, 1.0] so the curve never goes back in time. y can go outside [0.0, 1.0] to overshoot
+    // NOTE make these while loading, not while an AnimaticWrapper is updating in parallel
+    x1 = std::min(1.0f, std::max(0.0f, x1));
+    x2 = std::min(1.0f, std::max(0.0f, x2));
+    EasingTable table;
+    table.value[0] = 0.0;
+    // Walk the curve in small steps, filling in each sample once the curve's x passes it
+    const int steps = EASING_SAMPLES * 8;
+    int i = 1;
+    float lastX = 0.0;
+    float lastY = 0.0;
+    for (int step = 1; step <= steps && i < EASING_SAMPLES; step++)
+    {
+        float u = (float)step / steps;
+        float v = 1.0 - u;
+        float x = 3.0 * v * v * u * x1 + 3.0 * v * u * u * x2 + u * u * u;
+        float y = 3.0 * v * v * u * y1 + 3.0 * v * u * u * y2 + u * u * u;
+        for (; i < EASING_SAMPLES && (float)i / EASING_SAMPLES <= x; i++)
+        {
+            float along = (x > lastX) ? ((float)i / EASING_SAMPLES - lastX) / (x - lastX) : 1.0;
+            table.value[i] = lastY + (y - lastY) * along;
+        }
+        lastX = x;
+        lastY = y;
+    }
+    for (; i <= EASING_SAMPLES; i++) {table.value[i] = 1.0;}
+    std::vector<EasingTable>& tables = anim_easing_tables();
+    tables.push_back(table);
+    return tables.size() - 1;
+}
+
+float anim_ease(const EasingTable& table, float t)
+{
+    // Returns progress t (in range [0.0, 1.0]) shaped by an easing table
+    const float* value = table.value;
+    if (t <= 0.0) {return value[0];}
+    if (t >= 1.0) {return value[EASING_SAMPLES];}
+    float position = t * EASING_SAMPLES;
+    int i = position;
+    return value[i] + (value[i + 1] - value[i]) * (position - i);
+}
+
+float anim_ease(int easing, float t)
+{
+    // Returns progress t (in range [0.0, 1.0]) shaped by an easing. Back easings (and some Beziers) go outside [0.0, 1.0] partway
+    if (easing == EASE_LINEAR) {return t;}
+    const std::vector<EasingTable>& tables = anim_easing_tables();
+    if (easing < 0 || easing >= (int)tables.size()) {return t;}
+    return anim_ease(tables[easing], t);
+}
+
+int anim_frames(Animation& anim, double milliseconds)
+{
+    // Moves a spritesheet animation's clock forward, returning how many frames it should advance by
+    if (anim.timed)
+    {
+        if (anim.duration <= 0.0) {return 1;}
+        anim.elapsed += milliseconds;
+        int frames = anim.elapsed / anim.duration;
+        anim.elapsed -= frames * anim.duration;
+        return frames;
+    }
+    anim.currentTicks++;
+    if (anim.currentTicks < anim.ticksPerFrame) {return 0;}
+    anim.currentTicks = 0;
+    return 1;
+}
+
+float anim_advance(Animation& anim, double milliseconds)
+{
+    // Moves a timed animation's clock forward, returning how far through it is in range [0.0, 1.0]
+    anim.elapsed = std::min((double)anim.duration, anim.elapsed + milliseconds);
+    return (anim.duration > 0.0) ? anim.elapsed / anim.duration : 1.0;
+}
+
+bool anim_track_advance(const KeyframeTrack& track, float& elapsed, double milliseconds, bool loops)
+{
+    // Moves a track's clock forward, returning true once a track that doesn't loop has reached its last keyframe
+    float length = track.length();
+    elapsed += milliseconds;
+    if (elapsed < length) {return false;}
+    if (loops && length > 0.0)
+    {
+        elapsed = std::fmod(elapsed, length);
+        return false;
+    }
+    elapsed = length;
+    return true;
+}
+
+float anim_loop(Animation& anim, double milliseconds)
+{
+    // Moves a looping timed animation's clock forward, wrapping around at the end. Returns how far through the current loop it is
+    if (anim.duration <= 0.0) {return 1.0;}
+    anim.elapsed = std::fmod(anim.elapsed + milliseconds, (double)anim.duration);
+    return anim.elapsed / anim.duration;
+}
+
+vec2 MotionPath::at(float distance) const
+{
+    // Where the path is distance along it (clamped to the ends)
+    if (samples.empty()) {return {0.0, 0.0};}
+    if (distance <= 0.0 || length <= 0.0) {return samples.front();}
+    float position = distance / spacing;
+    int i = position;
+    if (i >= (int)samples.size() - 1) {return samples.back();}
+    return anim_lerp(samples[i], samples[i + 1], position - i);
+}
+
+MotionPath anim_path_resample(const std::vector<vec2>& points, float spacing)
+{
+    // Makes a MotionPath from a polyline by measuring it and placing samples at even distances along it
+    // NOTE corners sharper than the sample spacing get cut slightly, by up to half of spacing
+    MotionPath path;
+    if (points.empty()) {return path;}
+    std::vector<float> lengths(points.size(), 0.0); // Of the segment ending at each point
+    for (int i = 1; i < (int)points.size(); i++)
+    {
+        lengths[i] = std::hypot(points[i].x - points[i - 1].x, points[i].y - points[i - 1].y);
+        path.length += lengths[i];
+    }
+    const int maxSamples = 65536;
+    int count = std::max(2, std::min(maxSamples, (int)std::ceil(path.length / std::max(0.01f, spacing)) + 1));
+    path.spacing = (path.length > 0.0) ? path.length / (count - 1) : 1.0;
+    path.samples.reserve(count);
+    int segment = 1;
+    float segmentStart = 0.0; // Distance along the path to the start of segment
+    for (int k = 0; k < count; k++)
+    {
+        float distance = (k == count - 1) ? path.length : k * path.spacing;
+        while (segment < (int)points.size() - 1 && segmentStart + lengths[segment] < distance)
+        {
+            segmentStart += lengths[segment];
+            segment++;
+        }
+        if (segment >= (int)points.size())
+        {
+            path.samples.push_back(points.back()); // Only one point
+            continue;
+        }
+        float t = (lengths[segment] > 0.0) ? (distance - segmentStart) / lengths[segment] : 0.0;
+        path.samples.push_back(anim_lerp(points[segment - 1], points[segment], std::min(1.0f, std::max(0.0f, t))));
+    }
+    return path;
+}
+
+int anim_path_steps(const std::vector<vec2>& controls, float spacing)
+{
+    // How many straight pieces to flatten a curve into before resampling. The control polygon is never shorter than the curve, so this is enough
+    float rough = 0.0;
+    for (int i = 1; i < (int)controls.size(); i++) {rough += std::hypot(controls[i].x - controls[i - 1].x, controls[i].y - controls[i - 1].y);}
+    return std::max(16, std::min(8192, (int)(rough / std::max(0.01f, spacing)) * 2));
+}
+
+MotionPath anim_path_polyline(const std::vector<vec2>& points, float spacing = 4.0)
+{
+    // Makes a path through points in straight lines. spacing is the distance between the samples it keeps
+    return anim_path_resample(points, spacing);
+}
+
+MotionPath anim_path_quadratic(vec2 start, vec2 control, vec2 end, float spacing = 4.0)
+{
+    // Makes a path along a quadratic Bezier curve
+    int steps = anim_path_steps({start, control, end}, spacing);
+    std::vector<vec2> points;
+    points.reserve(steps + 1);
+    for (int i = 0; i <= steps; i++)
+    {
+        float t = (float)i / steps;
+        float u = 1.0 - t;
+        points.push_back({u * u * start.x + 2.0f * u * t * control.x + t * t * end.x, u * u * start.y + 2.0f * u * t * control.y + t * t * end.y});
+    }
+    return anim_path_resample(points, spacing);
+}
+
+MotionPath anim_path_cubic(vec2 start, vec2 control1, vec2 control2, vec2 end, float spacing = 4.0)
+{
+    // Makes a path along a cubic Bezier curve
+    int steps = anim_path_steps({start, control1, control2, end}, spacing);
+    std::vector<vec2> points;
+    points.reserve(steps + 1);
+    for (int i = 0; i <= steps; i++)
+    {
+        float t = (float)i / steps;
+        float u = 1.0 - t;
+        float a = u * u * u;
+        float b = 3.0f * u * u * t;
+        float c = 3.0f * u * t * t;
+        float d = t * t * t;
+        points.push_back({a * start.x + b * control1.x + c * control2.x + d * end.x, a * start.y + b * control1.y + c * control2.y + d * end.y});
+    }
+    return anim_path_resample(points, spacing);
+}
+
+MotionPath anim_path_catmull_rom(const std::vector<vec2>& points, bool closed = false, float spacing = 4.0)
+{
+    // Makes a smooth path that passes through every point. Closed paths also curve from the last point back to the first (nice with looping)
+    int count = points.size();
+    if (count < 3) {return anim_path_resample(points, spacing);}
+    auto point = [&points, count, closed](int i)
+    {
+        if (closed) {return points[(i % count + count) % count];}
+        return points[std::min(count - 1, std::max(0, i))]; // Open ends repeat the end point
+    };
+    int spans = closed ? count : count - 1;
+    std::vector<vec2> flat;
+    for (int span = 0; span < spans; span++)
+    {
+        vec2 p0 = point(span - 1);
+        vec2 p1 = point(span);
+        vec2 p2 = point(span + 1);
+        vec2 p3 = point(span + 2);
+        int steps = anim_path_steps({p0, p1, p2, p3}, spacing) / 2;
+        for (int i = (span == 0) ? 0 : 1; i <= steps; i++)
+        {
+            float t = (float)i / steps;
+            float t2 = t * t;
+            float t3 = t2 * t;
+            flat.push_back({
+                0.5f * (2.0f * p1.x + (p2.x - p0.x) * t + (2.0f * p0.x - 5.0f * p1.x + 4.0f * p2.x - p3.x) * t2 + (3.0f * p1.x - p0.x - 3.0f * p2.x + p3.x) * t3),
+                0.5f * (2.0f * p1.y + (p2.y - p0.y) * t + (2.0f * p0.y - 5.0f * p1.y + 4.0f * p2.y - p3.y) * t2 + (3.0f * p1.y - p0.y - 3.0f * p2.y + p3.y) * t3)
+            });
+        }
+    }
+    return anim_path_resample(flat, spacing);
+}
+
+vec2 anim_track_value(const KeyframeTrack& track, float time, int& key)
+{
+    // Returns where a track is at time (milliseconds from its start). key is the keyframe last passed, kept between calls
+    const std::vector<Keyframe>& keys = track.keys;
+    int last = keys.size() - 1;
+    if (last < 0) {return {0.0, 0.0};}
+    if (time <= keys[0].time)
+    {
+        key = 0;
+        return keys[0].value;
+    }
+    if (time >= keys[last].time)
+    {
+        key = last;
+        return keys[last].value;
+    }
+    if (key < 0 || key >= last || keys[key].time > time) {key = 0;} // Looped back (or never set)
+    while (keys[key + 1].time <= time) {key++;}
+    const Keyframe& from = keys[key];
+    const Keyframe& to = keys[key + 1];
+    float t = (time - from.time) / (to.time - from.time);
+    return anim_lerp(from.value, to.value, (from.easing == EASE_LINEAR) ? t : anim_ease(from.easing, t));
+}
+
 /// /// ///
 
 class Animatic
@@ -119,16 +633,24 @@ public:
     // Functions
     Animatic(SDL* SDLInstance, SDL_Texture* Texture); // Constructor
     void addAnimation(const Animation& anim); // Adds an animation given a bunch of data
-    void update(); // Ticks all of the animations
+    void update(); // Ticks all of the animations, with timed ones using sdl->deltatime (see SDL::FPSlog)
+    void update(double milliseconds); // Ticks all of the animations, with timed ones moving forward by the given time
+    void render(); // Draws source of texture to rect
     // Variables
     SDL_Texture* texture = nullptr; // The texture as the animation system sees it
     SDL_Rect rect = {0, 0, 0, 0}; // The position and size as the animation system sees it
+    SDL_Rect source = {0, 0, 0, 0}; // The part of texture to draw. Empty (the default) draws all of it. Set by direct spritesheet animations
+    uint8_t alpha = 255; // The current fade. Fades also set it as the texture's alpha mod, but a SpriteBatch draws with this instead
+    int layer = 0; // A SpriteBatch draws lower layers first
     //bool purgeOnComplete = true; // Whether or not this Animatic is destroyed after all animations finish
     std::vector<Animation> animations; // The collection of all animations currently playing on this Animatic
 private:
     // Functions
+    void applyTrack(TrackProperty property, vec2 value); // Sets whatever a track animates. Alpha only changes the alpha variable, not the texture
     // Variables
     SDL* sdl; // SDL instance
+    int wrapperSlot = -1; // Where this is stored in the AnimaticWrapper that made it, if any
+    friend class AnimaticWrapper;
 };
 
 Animatic::Animatic(SDL* SDLInstance, SDL_Texture* Texture)
@@ -144,9 +666,40 @@ void Animatic::addAnimation(const Animation& anim)
     animations.push_back(anim);
 }
 
+void Animatic::render()
+{
+    // Draws source of texture to rect
+    SDL_RenderCopy(sdl->renderer, texture, (source.w > 0) ? &source : nullptr, &rect);
+}
+
+void Animatic::applyTrack(TrackProperty property, vec2 value)
+{
+    // Sets whatever a track animates. Alpha only changes the alpha variable, not the texture
+    switch (property) {
+    case TRACK_POSITION:
+        rect.x = value.x;
+        rect.y = value.y;
+        break;
+    case TRACK_SIZE:
+        rect.w = value.x;
+        rect.h = value.y;
+        break;
+    case TRACK_ALPHA:
+        alpha = std::min(255.0f, std::max(0.0f, value.x * 255.0f));
+        break;
+    }
+}
+
 void Animatic::update()
 {
-    // Ticks all of the animations
+    // Ticks all of the animations, with timed ones using sdl->deltatime (see SDL::FPSlog)
+    update(sdl->deltatime);
+}
+
+void Animatic::update(double milliseconds)
+{
+    // Ticks all of the animations. Untimed ones always move one tick, timed ones move forward by the given time
+    SDL_PROFILE_ZONE("Animatic::update");
     for (auto anim = animations.begin(); anim != animations.end(); )
     {
         if (anim->complete) {anim = animations.erase(anim);} // Erase the animation if complete
@@ -154,16 +707,28 @@ void Animatic::update()
         {
             // Do animation things
             switch(anim->type) {
-            case ANIMATION_SPRITESHEET:
-                anim->currentTicks++;
-                if (anim->currentTicks >= anim->ticksPerFrame) {
-                    anim->currentTicks = 0;
-                    anim->currentFrame++;
+            case ANIMATION_SPRITESHEET: {
+                if (anim->direct) {
+                    // Draw from the sheet itself. Set every tick (it's only a couple of copies) so the first frame shows right away
+                    texture = anim->sheet;
+                    source = anim->frameRect;
+                }
+                int frames = anim_frames(*anim, milliseconds);
+                if (frames > 0) {
+                    anim->currentFrame += frames;
                     if (anim->currentFrame >= anim->totalFrames) {
-                        anim->currentFrame = 0;
-                        if (!anim->loops) {anim->complete = true;}
+                        if (anim->loops) {anim->currentFrame %= anim->totalFrames;}
+                        else {
+                            anim->currentFrame = 0;
+                            anim->complete = true;
+                        }
+                    }
+                    anim->frameRect.x = anim->origin.x + anim->currentFrame % anim->columns * anim->frameRect.w;
+                    anim->frameRect.y = anim->origin.y + anim->currentFrame / anim->columns * anim->frameRect.h;
+                    if (anim->direct) {
+                        source = anim->frameRect;
+                        break;
                     }
-                    anim->frameRect.x = anim->frameRect.w * anim->currentFrame;
                     SDL_Texture* originalTexture = SDL_GetRenderTarget(sdl->renderer);
                     SDL_SetRenderTarget(sdl->renderer, texture);
                     SDL_SetRenderDrawColor(sdl->renderer, 0, 0, 0, 0);
@@ -173,7 +738,16 @@ void Animatic::update()
                     SDL_SetRenderTarget(sdl->renderer, originalTexture);
                 }
                 break;
+            }
             case ANIMATION_MOVE:
+                if (anim->timed) {
+                    float t = anim_advance(*anim, milliseconds);
+                    anim->currentPos = anim_lerp(anim->startPos, anim->targetPos, anim_ease(anim->easing, t));
+                    if (t >= 1.0) {anim->complete = true;}
+                    rect.x = anim->currentPos.x;
+                    rect.y = anim->currentPos.y;
+                    break;
+                }
                 anim->currentPos.x += anim->deltaPos.x;
                 anim->currentPos.y += anim->deltaPos.y;
                 if (anim->currentPos.x > anim->targetPos.x && anim->deltaPos.x >= 0.0) {anim->currentPos.x = anim->targetPos.x;}
@@ -187,6 +761,14 @@ void Animatic::update()
                 rect.y = anim->currentPos.y;
                 break;
             case ANIMATION_SCALE:
+                if (anim->timed) {
+                    float t = anim_advance(*anim, milliseconds);
+                    anim->currentScale = anim_lerp(anim->startScale, anim->targetScale, anim_ease(anim->easing, t));
+                    if (t >= 1.0) {anim->complete = true;}
+                    rect.w = anim->currentScale.x;
+                    rect.h = anim->currentScale.y;
+                    break;
+                }
                 anim->currentScale.x += anim->deltaScale.x;
                 anim->currentScale.y += anim->deltaScale.y;
                 if (anim->currentScale.x > anim->targetScale.x && anim->deltaScale.x >= 0.0) {anim->currentScale.x = anim->targetScale.x;}
@@ -200,11 +782,33 @@ void Animatic::update()
                 rect.h = anim->currentScale.y;
                 break;
             case ANIMATION_FADE:
+                if (anim->timed) {
+                    float t = anim_advance(*anim, milliseconds);
+                    anim->currentFade = anim_lerp(anim->startFade, anim->targetFade, anim_ease(anim->easing, t));
+                    if (t >= 1.0) {anim->complete = true;}
+                    alpha = std::min(255.0f, std::max(0.0f, anim->currentFade));
+                    SDL_SetTextureAlphaMod(texture, alpha);
+                    break;
+                }
                 anim->currentFade += anim->deltaFade;
                 if (anim->currentFade <= 0.0 || anim->currentFade >= 255.0) {
                     anim->complete = true;
                 }
-                SDL_SetTextureAlphaMod(texture, (uint8_t)anim->currentFade);
+                alpha = std::min(255.0f, std::max(0.0f, anim->currentFade));
+                SDL_SetTextureAlphaMod(texture, alpha);
+                break;
+            case ANIMATION_PATH: {
+                float t = anim->pathLoops ? anim_loop(*anim, milliseconds) : anim_advance(*anim, milliseconds);
+                if (t >= 1.0 && !anim->pathLoops) {anim->complete = true;}
+                vec2 position = anim->path->atFraction(anim_ease(anim->easing, t));
+                rect.x = position.x;
+                rect.y = position.y;
+                break;
+            }
+            case ANIMATION_TRACK:
+                if (anim_track_advance(*anim->track, anim->elapsed, milliseconds, anim->trackLoops)) {anim->complete = true;}
+                applyTrack(anim->track->property, anim_track_value(*anim->track, anim->elapsed, anim->currentKey));
+                if (anim->track->property == TRACK_ALPHA) {SDL_SetTextureAlphaMod(texture, alpha);}
                 break;
             default:
                 break;
@@ -216,22 +820,1266 @@ void Animatic::update()
     }
 }
 
-/*/// /// ///
+/// /// ///
+
+class SpriteBatch
+{
+    // Draws lots of Animatics with as few draw calls as possible
+    // Everything added in a frame is sorted by layer, and each run of Animatics sharing a texture (direct spritesheets, say) becomes one SDL_RenderGeometry call
+    // Position, size, source rect and alpha all go into the vertices, so a crowd drawing from one sheet is a single draw call
+    // NOTE within a layer, draw order between different textures is not kept. Use layers for anything that must overlap a certain way
+public:
+    // Functions
+    SpriteBatch(SDL* SDLInstance); // Constructor
+    void add(Animatic* animatic); // Queues an Animatic to be drawn by the next render()
+    void render(); // Draws everything queued, then empties the queue
+    // Variables
+    int drawCalls = 0; // How many draw calls the last render() made
+private:
+    // Types
+    struct Sprite {
+        int layer;
+        SDL_Texture* texture;
+        int order; // When it was added, to keep sorting stable
+        Animatic* animatic;
+    };
+    // Functions
+    void flush(SDL_Texture* texture, int first, int count); // Draws count quads from vertices[first * 4] with one call
+    // Variables
+    SDL* sdl; // SDL instance
+    std::vector<Sprite> sprites; // Queued this frame
+    std::vector<SDL_Vertex> vertices; // 4 per sprite, kept between frames so they don't reallocate
+    std::vector<int> indices; // 6 per quad, the same for every batch since each call starts at its own first vertex
+};
+
+SpriteBatch::SpriteBatch(SDL* SDLInstance)
+{
+    sdl = SDLInstance;
+}
+
+void SpriteBatch::add(Animatic* animatic)
+{
+    // Queues an Animatic to be drawn by the next render()
+    if (animatic->texture == nullptr) {return;}
+    sprites.push_back({animatic->layer, animatic->texture, (int)sprites.size(), animatic});
+}
+
+void SpriteBatch::render()
+{
+    // Draws everything queued, sorted by layer and grouped by texture, then empties the queue
+    SDL_PROFILE_ZONE("SpriteBatch::render");
+    drawCalls = 0;
+    std::sort(sprites.begin(), sprites.end(), [](const Sprite& a, const Sprite& b)
+    {
+        if (a.layer != b.layer) {return a.layer < b.layer;}
+        if (a.texture != b.texture) {return std::less<SDL_Texture*>()(a.texture, b.texture);}
+        return a.order < b.order;
+    });
+    if (vertices.size() < sprites.size() * 4) {vertices.resize(sprites.size() * 4);}
+    while (indices.size() < sprites.size() * 6)
+    {
+        int first = indices.size() / 6 * 4;
+        indices.insert(indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+    }
+
+    int groupStart = 0;
+    SDL_Texture* groupTexture = nullptr;
+    int width = 1;
+    int height = 1;
+    float invWidth = 1.0;
+    float invHeight = 1.0;
+    for (int i = 0; i < (int)sprites.size(); i++)
+    {
+        Animatic* animatic = sprites[i].animatic;
+        if (animatic->texture != groupTexture)
+        {
+            // New texture, so draw everything before it
+            flush(groupTexture, groupStart, i - groupStart);
+            groupStart = i;
+            groupTexture = animatic->texture;
+            SDL_QueryTexture(groupTexture, nullptr, nullptr, &width, &height);
+            invWidth = 1.0f / width;
+            invHeight = 1.0f / height;
+        }
+        SDL_Rect source = animatic->source;
+        if (source.w <= 0) {source = {0, 0, width, height};} // The whole texture
+        float left = animatic->rect.x;
+        float top = animatic->rect.y;
+        float right = left + animatic->rect.w;
+        float bottom = top + animatic->rect.h;
+        float u0 = source.x * invWidth;
+        float v0 = source.y * invHeight;
+        float u1 = (source.x + source.w) * invWidth;
+        float v1 = (source.y + source.h) * invHeight;
+        SDL_Color color = {255, 255, 255, animatic->alpha};
+        SDL_Vertex* quad = &vertices[i * 4];
+        quad[0] = {{left, top}, color, {u0, v0}};
+        quad[1] = {{right, top}, color, {u1, v0}};
+        quad[2] = {{right, bottom}, color, {u1, v1}};
+        quad[3] = {{left, bottom}, color, {u0, v1}};
+    }
+    flush(groupTexture, groupStart, sprites.size() - groupStart);
+    sprites.clear();
+}
+
+void SpriteBatch::flush(SDL_Texture* texture, int first, int count)
+{
+    // Draws count quads from vertices[first * 4] with one call
+    if (count <= 0 || texture == nullptr) {return;}
+    SDL_RenderGeometry(sdl->renderer, texture, &vertices[first * 4], count * 4, indices.data(), count * 6);
+    drawCalls++;
+}
+
+/// /// ///
+
+class SpriteAtlas
+{
+    // Packs many spritesheets into a few big atlas pages, so Animatics of different characters can still share a texture (and a SpriteBatch draw call)
+    // Add every sheet first, then pack() once. Frames are re-gridded to fit the page width, so even very long strips pack fine
+    // Play a packed sheet with anim_spritesheet(atlas.region(id), ...). Regions stay valid for as long as the atlas does
+public:
+    // Functions
+    SpriteAtlas(SDL* SDLInstance, int pageWidth = 2048, int pageHeight = 2048); // Constructor. Pages can't be bigger than the renderer's max texture size
+    ~SpriteAtlas();
+    SpriteAtlas(const SpriteAtlas&) = delete; // Owns its pages
+    SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+    int add(std::string filepath, int frameWidth, int frameHeight, int frames = 0); // Queues a row-major grid sheet for packing and returns its id. 0 frames means every whole cell
+    int add(SDL_Surface* surface, int frameWidth, int frameHeight, int frames = 0); // The same from a surface, which the atlas takes (and frees)
+    void pack(); // Packs everything added since the last pack() into pages (new pages, so earlier regions don't move)
+    const SheetRegion& region(int id); // Where a sheet ended up. Its texture is nullptr until packed (or if it couldn't fit)
+    int pageCount() {return pages.size();}
+private:
+    // Types
+    struct Pending {
+        int id;
+        SDL_Surface* surface;
+    };
+    // Variables
+    SDL* sdl; // SDL instance
+    int pageWidth;
+    int pageHeight;
+    std::vector<SheetRegion> regions; // By id
+    std::vector<Pending> pending; // Added but not yet packed
+    std::vector<SDL_Texture*> pages;
+};
+
+SpriteAtlas::SpriteAtlas(SDL* SDLInstance, int PageWidth, int PageHeight)
+{
+    sdl = SDLInstance;
+    pageWidth = PageWidth;
+    pageHeight = PageHeight;
+}
+
+SpriteAtlas::~SpriteAtlas()
+{
+    for (Pending& sheet : pending) {SDL_FreeSurface(sheet.surface);}
+    for (SDL_Texture* page : pages) {SDL_DestroyTexture(page);}
+}
+
+int SpriteAtlas::add(std::string filepath, int frameWidth, int frameHeight, int frames)
+{
+    // Queues a row-major grid sheet for packing and returns its id. 0 frames means every whole cell
+    return add(sdl->loadSurface(filepath), frameWidth, frameHeight, frames);
+}
+
+int SpriteAtlas::add(SDL_Surface* surface, int frameWidth, int frameHeight, int frames)
+{
+    // The same from a surface, which the atlas takes (and frees)
+    SheetRegion sheet;
+    sheet.frameWidth = frameWidth;
+    sheet.frameHeight = frameHeight;
+    if (surface != nullptr && frameWidth > 0 && frameHeight > 0)
+    {
+        // Remember the source grid in columns for now. pack() changes it to the packed grid
+        sheet.columns = surface->w / frameWidth;
+        int cells = sheet.columns * (surface->h / frameHeight);
+        sheet.frames = (frames > 0) ? std::min(frames, cells) : cells;
+    }
+    regions.push_back(sheet);
+    if (sheet.frames > 0) {pending.push_back({(int)regions.size() - 1, surface});}
+    else {SDL_FreeSurface(surface);}
+    return regions.size() - 1;
+}
+
+void SpriteAtlas::pack()
+{
+    // Packs everything added since the last pack() into pages, tallest first in rows (shelves)
+    // Each sheet keeps its frames in a row-major grid, just as wide as the page allows
+    struct Placed {
+        int columns;
+        int width;
+        int height;
+    };
+    std::vector<Placed> sizes(regions.size());
+    for (Pending& sheet : pending)
+    {
+        SheetRegion& region = regions[sheet.id];
+        Placed& size = sizes[sheet.id];
+        size.columns = std::max(1, std::min(region.frames, pageWidth / region.frameWidth));
+        size.width = size.columns * region.frameWidth;
+        size.height = (region.frames + size.columns - 1) / size.columns * region.frameHeight;
+    }
+    std::stable_sort(pending.begin(), pending.end(), [&sizes](const Pending& a, const Pending& b) {return sizes[a.id].height > sizes[b.id].height;});
+
+    SDL_Surface* page = nullptr;
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    std::vector<int> onPage; // Ids of the sheets on the page being filled
+    auto finishPage = [&]()
+    {
+        if (page == nullptr) {return;}
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(sdl->renderer, page);
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        SDL_FreeSurface(page);
+        page = nullptr;
+        pages.push_back(texture);
+        for (int id : onPage) {regions[id].texture = texture;}
+        onPage.clear();
+    };
+    for (Pending& sheet : pending)
+    {
+        SheetRegion& region = regions[sheet.id];
+        const Placed& size = sizes[sheet.id];
+        if (size.width > pageWidth || size.height > pageHeight)
+        {
+            std::cout << "Spritesheet " << sheet.id << " (" << size.width << "x" << size.height << ") doesn't fit on a " << pageWidth << "x" << pageHeight << " atlas page!" << std::endl;
+            SDL_FreeSurface(sheet.surface);
+            continue;
+        }
+        // Next shelf, or next page, if it doesn't fit
+        if (page != nullptr && shelfX + size.width > pageWidth)
+        {
+            shelfX = 0;
+            shelfY += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (page != nullptr && shelfY + size.height > pageHeight) {finishPage();}
+        if (page == nullptr)
+        {
+            page = SDL_CreateRGBSurfaceWithFormat(0, pageWidth, pageHeight, 32, SDL_PIXELFORMAT_RGBA32);
+            shelfX = 0;
+            shelfY = 0;
+            shelfHeight = 0;
+        }
+
+        // Copy the frames over one at a time, re-gridding them to the packed number of columns
+        SDL_SetSurfaceBlendMode(sheet.surface, SDL_BLENDMODE_NONE);
+        int sourceColumns = region.columns;
+        for (int frame = 0; frame < region.frames; frame++)
+        {
+            SDL_Rect source = {(frame % sourceColumns) * region.frameWidth, (frame / sourceColumns) * region.frameHeight, region.frameWidth, region.frameHeight};
+            SDL_Rect destination = {shelfX + (frame % size.columns) * region.frameWidth, shelfY + (frame / size.columns) * region.frameHeight, region.frameWidth, region.frameHeight};
+            SDL_BlitSurface(sheet.surface, &source, page, &destination);
+        }
+        SDL_FreeSurface(sheet.surface);
+        region.area = {shelfX, shelfY, size.width, size.height};
+        region.columns = size.columns;
+        onPage.push_back(sheet.id);
+        shelfX += size.width;
+        shelfHeight = std::max(shelfHeight, size.height);
+    }
+    finishPage();
+    pending.clear();
+}
+
+const SheetRegion& SpriteAtlas::region(int id)
+{
+    // Where a sheet ended up. Its texture is nullptr until packed (or if it couldn't fit)
+    return regions[id];
+}
+
+/// /// ///
+
+struct AnimationHandle {    // Refers to one animation added to an AnimaticWrapper. Safe to keep after the animation ends (it just stops matching anything)
+    int index = -1;         // Which handle slot
+    unsigned generation = 0; // Which use of that slot. Goes up every time the slot is freed
+};
+
+enum AnimationStatus
+{
+    ANIMATION_FINISHED,     // Completed, cancelled, or its Animatic was destroyed (or the handle never referred to anything)
+    ANIMATION_WAITING,      // Added behind a queued animation that is still playing
+    ANIMATION_PLAYING       // Ticking
+};
+
+template <typename T>
+void swapRemove(std::vector<T>& values, int i)
+{
+    // Removes values[i] in constant time by moving the last value into its place. Changes the order
+    values[i] = values.back();
+    values.pop_back();
+}
 
 class AnimaticWrapper
 {
     // A wrapper for a set of Animatics, handling creation/destruction as well as batch updating
+    // Animations are stored by type as structure-of-arrays (every move's position together, every fade's alpha together, etc.),
+    // so updateAll() is a few tight loops no matter how many Animatics there are. Finished animations are swap-removed
+    // Queued animations work like they do on a lone Animatic: anything added after one waits until it is complete
+    // With parallel set, the math is split into chunks across sharedWorkerPool(), and anything that needs the renderer
+    // (spritesheet frame copies, alpha mods) is collected and done afterwards on the calling thread
+    // NOTE in parallel mode, two animations of the same kind playing on one Animatic at once (two moves, say) race, so which one wins is unspecified
+    // addAnimation() returns a generation-checked handle, which can cancel or ask about that animation in O(1). Animations, handles, and
+    // waiting animations all live in pooled arrays, so once they have grown to fit a scene nothing allocates
+    // With culling set, renderAll() files every Animatic into a uniform grid of cells and only looks at the cells over the viewport.
+    // Off-screen Animatics still keep time, but skip spritesheet frame copies and draw calls, so a big scrolling world costs about what's on screen
 public:
     // Functions
-    AnimaticWrapper(SDL_Renderer* Renderer); // Constructor
+    AnimaticWrapper(SDL* SDLInstance); // Constructor
+    AnimaticWrapper(const AnimaticWrapper&) = delete; // Owns its Animatics
+    AnimaticWrapper& operator=(const AnimaticWrapper&) = delete;
+    Animatic* create(SDL_Texture* Texture); // Makes a new Animatic owned by this wrapper
+    void destroy(Animatic* animatic); // Destroys an Animatic made by create(), along with all of its animations
+    AnimationHandle addAnimation(Animatic* animatic, const Animation& anim); // Plays an animation on an Animatic made by create()
+    bool cancel(AnimationHandle handle); // Stops an animation, returning false if it had already finished. Cancelling a queued animation lets the ones behind it start
+    AnimationStatus status(AnimationHandle handle); // Whether an animation is waiting, playing, or finished
+    void updateAll(); // Ticks every animation of every Animatic, with timed ones using sdl->deltatime (see SDL::FPSlog)
+    void updateAll(double milliseconds); // Ticks every animation of every Animatic, with timed ones moving forward by the given time
+    void renderAll(); // Draws every Animatic through a SpriteBatch, so ones sharing a texture cost one draw call together
+    int activeAnimations(); // How many animations are ticking (not counting ones waiting behind a queued animation, or of Animatics destroyed since the last update)
+    void setCellSize(int size); // Sets the side of each culling grid cell in pixels. About the size of a typical Animatic (or a bit bigger) works best
+    bool isVisible(Animatic* animatic); // Whether the last renderAll() found an Animatic in (or within cullMargin of) the viewport. Always true without culling
+    int visibleCount() {return visibleSlots.size();} // How many Animatics the last culled renderAll() found in view
     // Variables
+    bool parallel = false; // Whether updateAll() spreads its work across sharedWorkerPool(). Worth it from about 10k animations
+    int chunkSize = 4096; // How many animations each parallel job steps
+    bool culling = false; // Whether renderAll() only draws (and updateAll() only copies spritesheet frames for) Animatics in view
+    SDL_Rect viewport = {0, 0, 0, 0}; // The part of the world on screen, for culling. Empty (the default) means the window
+    int cullMargin = 64; // Pixels around the viewport that still count as visible, so spritesheets coming into view already show the right frame
 private:
+    // Types
+    enum Kind : uint8_t {                       // Where the animation a handle refers to is stored
+        KIND_FREE,
+        KIND_WAITING,
+        KIND_SPRITESHEET,
+        KIND_MOVE,
+        KIND_SCALE,
+        KIND_FADE,
+        KIND_TIMED_MOVE,
+        KIND_TIMED_SCALE,
+        KIND_TIMED_FADE,
+        KIND_TRACK_POSITION,                    // Tracks, in TrackProperty order
+        KIND_TRACK_SIZE,
+        KIND_TRACK_ALPHA,
+        KIND_PATH
+    };
+    struct HandleSlot {                         // Where one animation is right now
+        unsigned generation = 0;
+        uint8_t kind = KIND_FREE;
+        int position = -1;                      // Index into the arrays of its kind, or its WaitingNode. For free slots, the next free slot
+    };
+    struct WaitingNode {                        // An animation added while a queued animation was still playing
+        Animation anim;
+        int handle;                             // -1 if cancelled
+        int next;                               // Next node in the same Queue (or free list). -1 at the end
+    };
+    struct Queue {                              // The animations waiting to play on one Animatic, as a list of WaitingNodes
+        int head = -1;
+        int tail = -1;
+        bool blocked = false;                   // Whether a queued animation is playing
+    };
+    struct SpritesheetAnimations {              // Every playing spritesheet animation, one entry per index
+        std::vector<int> owner;                 // Slot of the Animatic being animated
+        std::vector<int> handle;                // Its HandleSlot
+        std::vector<uint8_t> queued;
+        std::vector<SDL_Texture*> sheet;
+        std::vector<SDL_Rect> frameRect;
+        std::vector<SDL_Point> origin;
+        std::vector<int> columns;
+        std::vector<uint8_t> ticksPerFrame;
+        std::vector<uint8_t> currentTicks;
+        std::vector<int> currentFrame;
+        std::vector<int> totalFrames;
+        std::vector<uint8_t> loops;
+        std::vector<uint8_t> direct;
+        std::vector<uint8_t> timed;
+        std::vector<float> frameTime;           // Timed: milliseconds per frame
+        std::vector<float> elapsed;             // Timed: milliseconds into the current frame
+        std::vector<uint8_t> stale;             // Changed frame while culled, so the frame still needs copying
+        void push(int slot, int handleIndex, const Animation& anim);
+        void remove(int i);
+    };
+    struct VectorAnimations {                   // Every playing move (or scale) animation
+        std::vector<int> owner;
+        std::vector<int> handle;
+        std::vector<uint8_t> queued;
+        std::vector<vec2> current;
+        std::vector<vec2> target;
+        std::vector<vec2> delta;
+        void push(int slot, int handleIndex, bool isQueued, vec2 start, vec2 end, vec2 step);
+        void remove(int i);
+    };
+    struct FadeAnimations {                     // Every playing fade animation
+        std::vector<int> owner;
+        std::vector<int> handle;
+        std::vector<uint8_t> queued;
+        std::vector<float> current;
+        std::vector<float> delta;
+        void push(int slot, int handleIndex, const Animation& anim);
+        void remove(int i);
+    };
+    template <typename T>
+    struct TimedAnimations {                    // Every playing timed move or scale (T = vec2), or fade (T = float)
+        std::vector<int> owner;
+        std::vector<int> handle;
+        std::vector<uint8_t> queued;
+        std::vector<T> start;
+        std::vector<T> target;
+        std::vector<float> duration;
+        std::vector<float> elapsed;
+        std::vector<int> easing;
+        void push(int slot, int handleIndex, bool isQueued, T from, T to, float milliseconds, float played, int curve)
+        {
+            owner.push_back(slot);
+            handle.push_back(handleIndex);
+            queued.push_back(isQueued);
+            start.push_back(from);
+            target.push_back(to);
+            duration.push_back(milliseconds);
+            elapsed.push_back(played);
+            easing.push_back(curve);
+        }
+        void remove(int i)
+        {
+            swapRemove(owner, i);
+            swapRemove(handle, i);
+            swapRemove(queued, i);
+            swapRemove(start, i);
+            swapRemove(target, i);
+            swapRemove(duration, i);
+            swapRemove(elapsed, i);
+            swapRemove(easing, i);
+        }
+        float advance(int i, double milliseconds)
+        {
+            // Moves animation i's clock forward, returning how far through it is in range [0.0, 1.0]
+            elapsed[i] = std::min((double)duration[i], elapsed[i] + milliseconds);
+            return (duration[i] > 0.0) ? elapsed[i] / duration[i] : 1.0;
+        }
+    };
+    struct PathAnimations {                     // Every playing path animation
+        std::vector<int> owner;
+        std::vector<int> handle;
+        std::vector<uint8_t> queued;
+        std::vector<const MotionPath*> path;
+        std::vector<float> duration;
+        std::vector<float> elapsed;
+        std::vector<int> easing;
+        std::vector<uint8_t> loops;
+        void push(int slot, int handleIndex, const Animation& anim, int curve);
+        void remove(int i);
+    };
+    struct TrackAnimations {                    // Every playing KeyframeTrack of one TrackProperty
+        std::vector<int> owner;
+        std::vector<int> handle;
+        std::vector<uint8_t> queued;
+        std::vector<const KeyframeTrack*> track;
+        std::vector<float> elapsed;
+        std::vector<int> key;                   // Keyframe last passed
+        std::vector<uint8_t> loops;
+        void push(int slot, int handleIndex, const Animation& anim);
+        void remove(int i);
+    };
+    struct RenderCommand {                      // A renderer call deferred until every chunk is done
+        SDL_Texture* texture;                   // The texture to change
+        SDL_Texture* sheet;                     // If set, copy frame of this into texture. Otherwise set the alpha mod of texture
+        SDL_Rect frame;
+        uint8_t alpha;
+    };
+    struct GridPlace {                          // Where one Animatic is filed in the culling grid
+        long long cell = NO_CELL;
+        int index = -1;                         // Where in that cell's list
+        uint8_t visible = 0;                    // Found in view by the last cull()
+    };
+    struct Chunk {                              // What one slice of an update found
+        std::vector<int> done;                  // Indices of animations that finished (or whose Animatic was destroyed), increasing
+        std::vector<RenderCommand> commands;
+    };
     // Functions
+    template <typename Animations, typename Step> void step(Animations& animations, const Step& stepOne); // Steps every animation of one type. stepOne(i, chunk) returns true once animation i is done
+    void stepTracks(TrackAnimations& playing, double milliseconds); // Steps every track of one property
+    void activate(int slot, int handle, const Animation& anim); // Starts an animation playing
+    void copyFrame(SDL_Texture* texture, SDL_Texture* sheet, const SDL_Rect& frame); // Copies one spritesheet frame into an Animatic's texture
+    void cull(); // Refiles moved Animatics in the grid, then marks the ones in the viewport (plus cullMargin) visible
+    void unfile(int slot); // Takes an Animatic out of its grid cell
+    SDL_Rect view(int margin); // The viewport (or window) grown by margin on every side
+    long long cellAt(int x, int y); // Key of the grid cell holding a point
+    static long long cellKey(long long cellX, long long cellY); // Packs a cell's column and row into one key
+    void release(int slot); // Starts whatever was waiting behind a finished queued animation
+    template <typename Animations> void removeAt(Animations& animations, int i); // Swap-removes animation i, keeping the handles pointing at the right places
+    int newHandle(); // Takes a free HandleSlot
+    void freeHandle(int handle); // Returns a HandleSlot, so every handle to it stops matching
+    int ownerOf(const HandleSlot& handle); // Slot of the Animatic a playing animation is on
+    static bool stepTowards(vec2& current, const vec2& target, const vec2& delta); // Moves current by delta without passing target. True once it's there
+    static float ease(const EasingTable* easings, int easing, float t); // anim_ease without the table lookup. easing must be valid (activate() checks)
     // Variables
-    SDL_Renderer* renderer = nullptr; // Pointer to the current SDL renderer
+    SDL* sdl; // SDL instance
+    std::vector<std::unique_ptr<Animatic>> animatics; // Every Animatic made by create(), indexed by Animatic::wrapperSlot. nullptr if free
+    std::vector<Queue> queues; // Same indices. Kept apart so updateAll() only walks the (small) pointers
+    std::vector<HandleSlot> handles; // Every handle ever given out, reused through freeHandles
+    int freeHandles = -1; // First free HandleSlot
+    std::vector<WaitingNode> waitingNodes; // Every Queue's nodes, reused through freeWaiting
+    int freeWaiting = -1; // First free WaitingNode
+    std::vector<int> freeSlots; // Slots of destroyed Animatics, reused first
+    std::vector<int> destroyedSlots; // Slots destroyed since the last updateAll(). Their animations may still be in the arrays
+    std::vector<int> released; // Slots whose queued animation finished during this updateAll()
+    std::vector<Chunk> chunks; // One per slice of the last step()
+    static const long long NO_CELL = 0x7fffffffffffffffLL; // GridPlace::cell when not filed
+    int cellSize = 256;
+    std::unordered_map<long long, std::vector<int>> grid; // Slots of the Animatics whose top left is in each cell. Cells are kept once made, so refiling doesn't allocate
+    std::vector<GridPlace> places; // By slot, like animatics
+    std::vector<int> visibleSlots; // Slots the last cull() found, in increasing order
+    SDL_Point largest = {0, 0}; // Widest and tallest Animatic at the last cull(), so big ones poking into view from outside its cells are still found
+    SpriteBatch batch; // For renderAll()
+    SpritesheetAnimations spritesheets;
+    VectorAnimations moves;
+    VectorAnimations scales;
+    FadeAnimations fades;
+    TimedAnimations<vec2> timedMoves;
+    TimedAnimations<vec2> timedScales;
+    TimedAnimations<float> timedFades;
+    TrackAnimations tracks[3]; // Indexed by TrackProperty, so each batch only writes one thing
+    PathAnimations paths;
 };
 
-AnimaticWrapper::AnimaticWrapper(SDL_Renderer* Renderer)
+AnimaticWrapper::AnimaticWrapper(SDL* SDLInstance) : batch(SDLInstance)
+{
+    sdl = SDLInstance;
+}
+
+Animatic* AnimaticWrapper::create(SDL_Texture* Texture)
+{
+    // Makes a new Animatic owned by this wrapper
+    int slot = animatics.size();
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        animatics.emplace_back();
+        queues.emplace_back();
+        places.emplace_back();
+    }
+    animatics[slot].reset(new Animatic(sdl, Texture));
+    animatics[slot]->wrapperSlot = slot;
+    return animatics[slot].get();
+}
+
+void AnimaticWrapper::destroy(Animatic* animatic)
+{
+    // Destroys an Animatic made by create(), along with all of its animations
+    if (animatic == nullptr) {return;}
+    // Its playing animations are dropped by the next updateAll(), and only then is the slot reused
+    int slot = animatic->wrapperSlot;
+    animatics[slot].reset();
+    unfile(slot);
+    Queue& queue = queues[slot];
+    for (int node = queue.head; node != -1; )
+    {
+        int next = waitingNodes[node].next;
+        if (waitingNodes[node].handle != -1) {freeHandle(waitingNodes[node].handle);}
+        waitingNodes[node].next = freeWaiting;
+        freeWaiting = node;
+        node = next;
+    }
+    queue = Queue();
+    destroyedSlots.push_back(slot);
+}
+
+AnimationHandle AnimaticWrapper::addAnimation(Animatic* animatic, const Animation& anim)
+{
+    // Plays an animation on an Animatic made by create(), returning a handle to it
+    int slot = animatic->wrapperSlot;
+    int handle = newHandle();
+    AnimationHandle result;
+    result.index = handle;
+    result.generation = handles[handle].generation;
+    Queue& queue = queues[slot];
+    if (!queue.blocked)
+    {
+        activate(slot, handle, anim);
+        return result;
+    }
+
+    // Wait at the back of the queue
+    int node = freeWaiting;
+    if (node != -1) {freeWaiting = waitingNodes[node].next;}
+    else
+    {
+        node = waitingNodes.size();
+        waitingNodes.emplace_back();
+    }
+    waitingNodes[node].anim = anim;
+    waitingNodes[node].handle = handle;
+    waitingNodes[node].next = -1;
+    if (queue.tail != -1) {waitingNodes[queue.tail].next = node;}
+    else {queue.head = node;}
+    queue.tail = node;
+    handles[handle].kind = KIND_WAITING;
+    handles[handle].position = node;
+    return result;
+}
+
+bool AnimaticWrapper::cancel(AnimationHandle handle)
+{
+    // Stops an animation, returning false if it had already finished. Cancelling a queued animation lets the ones behind it start
+    if (status(handle) == ANIMATION_FINISHED) {return false;}
+    HandleSlot& slot = handles[handle.index];
+    if (slot.kind == KIND_WAITING)
+    {
+        // Its node is skipped (and reused) once the queue reaches it
+        waitingNodes[slot.position].handle = -1;
+        freeHandle(handle.index);
+        return true;
+    }
+    int owner = ownerOf(slot);
+    int position = slot.position;
+    bool queued = false;
+    switch (slot.kind) {
+    case KIND_SPRITESHEET: queued = spritesheets.queued[position]; removeAt(spritesheets, position); break;
+    case KIND_MOVE: queued = moves.queued[position]; removeAt(moves, position); break;
+    case KIND_SCALE: queued = scales.queued[position]; removeAt(scales, position); break;
+    case KIND_FADE: queued = fades.queued[position]; removeAt(fades, position); break;
+    case KIND_TIMED_MOVE: queued = timedMoves.queued[position]; removeAt(timedMoves, position); break;
+    case KIND_TIMED_SCALE: queued = timedScales.queued[position]; removeAt(timedScales, position); break;
+    case KIND_TIMED_FADE: queued = timedFades.queued[position]; removeAt(timedFades, position); break;
+    case KIND_TRACK_POSITION:
+    case KIND_TRACK_SIZE:
+    case KIND_TRACK_ALPHA: {
+        TrackAnimations& playing = tracks[slot.kind - KIND_TRACK_POSITION];
+        queued = playing.queued[position];
+        removeAt(playing, position);
+        break;
+    }
+    case KIND_PATH: queued = paths.queued[position]; removeAt(paths, position); break;
+    default: break;
+    }
+    if (queued) {release(owner);}
+    return true;
+}
+
+AnimationStatus AnimaticWrapper::status(AnimationHandle handle)
+{
+    // Whether an animation is waiting, playing, or finished
+    if (handle.index < 0 || handle.index >= (int)handles.size()) {return ANIMATION_FINISHED;}
+    const HandleSlot& slot = handles[handle.index];
+    if (slot.generation != handle.generation || slot.kind == KIND_FREE) {return ANIMATION_FINISHED;}
+    if (slot.kind == KIND_WAITING) {return ANIMATION_WAITING;}
+    if (!animatics[ownerOf(slot)]) {return ANIMATION_FINISHED;} // Destroyed, just not swept up yet
+    return ANIMATION_PLAYING;
+}
+
+void AnimaticWrapper::updateAll()
+{
+    // Ticks every animation of every Animatic, with timed ones using sdl->deltatime (see SDL::FPSlog)
+    updateAll(sdl->deltatime);
+}
+
+void AnimaticWrapper::updateAll(double milliseconds)
+{
+    // Ticks every animation of every Animatic, one type at a time. Untimed ones always move one tick, timed ones move forward by the given time
+    // Each step below only does math on its own animation and Animatic. Renderer calls go into the chunk's command list, and finished animations
+    // into its done list, both applied by finish() on this thread. That keeps the steps safe to run on the worker pool (see parallel)
+    SDL_PROFILE_ZONE("AnimaticWrapper::updateAll");
+    step(spritesheets, [this, milliseconds](int i, Chunk& chunk)
+    {
+        Animatic* animatic = animatics[spritesheets.owner[i]].get();
+        if (animatic == nullptr) {return true;} // Destroyed
+        bool done = false;
+        int frames = 0;
+        if (spritesheets.timed[i])
+        {
+            float& elapsed = spritesheets.elapsed[i];
+            float frameTime = spritesheets.frameTime[i];
+            elapsed += milliseconds;
+            frames = (frameTime > 0.0) ? (int)(elapsed / frameTime) : 1;
+            if (frameTime > 0.0) {elapsed -= frames * frameTime;}
+        }
+        else if (++spritesheets.currentTicks[i] >= spritesheets.ticksPerFrame[i])
+        {
+            spritesheets.currentTicks[i] = 0;
+            frames = 1;
+        }
+        if (frames > 0)
+        {
+            spritesheets.currentFrame[i] += frames;
+            if (spritesheets.currentFrame[i] >= spritesheets.totalFrames[i])
+            {
+                if (spritesheets.loops[i]) {spritesheets.currentFrame[i] %= spritesheets.totalFrames[i];}
+                else
+                {
+                    spritesheets.currentFrame[i] = 0;
+                    done = true;
+                }
+            }
+            SDL_Rect& frameRect = spritesheets.frameRect[i];
+            const SDL_Point& origin = spritesheets.origin[i];
+            frameRect.x = origin.x + spritesheets.currentFrame[i] % spritesheets.columns[i] * frameRect.w;
+            frameRect.y = origin.y + spritesheets.currentFrame[i] / spritesheets.columns[i] * frameRect.h;
+            if (spritesheets.direct[i]) {animatic->source = frameRect;} // Just point at the next frame
+            else if (culling && !places[spritesheets.owner[i]].visible) {spritesheets.stale[i] = true;} // Copied once it comes into view
+            else
+            {
+                chunk.commands.push_back({animatic->texture, spritesheets.sheet[i], frameRect, 0});
+                spritesheets.stale[i] = false;
+            }
+        }
+        return done;
+    });
+    step(moves, [this](int i, Chunk&)
+    {
+        Animatic* animatic = animatics[moves.owner[i]].get();
+        if (animatic == nullptr) {return true;}
+        bool done = stepTowards(moves.current[i], moves.target[i], moves.delta[i]);
+        animatic->rect.x = moves.current[i].x;
+        animatic->rect.y = moves.current[i].y;
+        return done;
+    });
+    step(scales, [this](int i, Chunk&)
+    {
+        Animatic* animatic = animatics[scales.owner[i]].get();
+        if (animatic == nullptr) {return true;}
+        bool done = stepTowards(scales.current[i], scales.target[i], scales.delta[i]);
+        animatic->rect.w = scales.current[i].x;
+        animatic->rect.h = scales.current[i].y;
+        return done;
+    });
+    step(fades, [this](int i, Chunk& chunk)
+    {
+        Animatic* animatic = animatics[fades.owner[i]].get();
+        if (animatic == nullptr) {return true;}
+        fades.current[i] += fades.delta[i];
+        bool done = fades.current[i] <= 0.0 || fades.current[i] >= 255.0;
+        animatic->alpha = std::min(255.0f, std::max(0.0f, fades.current[i]));
+        chunk.commands.push_back({animatic->texture, nullptr, {0, 0, 0, 0}, animatic->alpha});
+        return done;
+    });
+    const EasingTable* easings = anim_easing_tables().data(); // Looked up once, not per animation
+    step(timedMoves, [this, milliseconds, easings](int i, Chunk&)
+    {
+        Animatic* animatic = animatics[timedMoves.owner[i]].get();
+        if (animatic == nullptr) {return true;}
+        float t = timedMoves.advance(i, milliseconds);
+        vec2 current = anim_lerp(timedMoves.start[i], timedMoves.target[i], ease(easings, timedMoves.easing[i], t));
+        animatic->rect.x = current.x;
+        animatic->rect.y = current.y;
+        return t >= 1.0;
+    });
+    step(timedScales, [this, milliseconds, easings](int i, Chunk&)
+    {
+        Animatic* animatic = animatics[timedScales.owner[i]].get();
+        if (animatic == nullptr) {return true;}
+        float t = timedScales.advance(i, milliseconds);
+        vec2 current = anim_lerp(timedScales.start[i], timedScales.target[i], ease(easings, timedScales.easing[i], t));
+        animatic->rect.w = current.x;
+        animatic->rect.h = current.y;
+        return t >= 1.0;
+    });
+    step(timedFades, [this, milliseconds, easings](int i, Chunk& chunk)
+    {
+        Animatic* animatic = animatics[timedFades.owner[i]].get();
+        if (animatic == nullptr) {return true;}
+        float t = timedFades.advance(i, milliseconds);
+        animatic->alpha = std::min(255.0f, std::max(0.0f, anim_lerp(timedFades.start[i], timedFades.target[i], ease(easings, timedFades.easing[i], t))));
+        chunk.commands.push_back({animatic->texture, nullptr, {0, 0, 0, 0}, animatic->alpha});
+        return t >= 1.0;
+    });
+    step(paths, [this, milliseconds, easings](int i, Chunk&)
+    {
+        Animatic* animatic = animatics[paths.owner[i]].get();
+        if (animatic == nullptr) {return true;}
+        float& elapsed = paths.elapsed[i];
+        float duration = paths.duration[i];
+        bool done = false;
+        if (paths.loops[i] && duration > 0.0) {elapsed = std::fmod(elapsed + milliseconds, (double)duration);}
+        else
+        {
+            elapsed = std::min((double)duration, elapsed + milliseconds);
+            done = elapsed >= duration;
+        }
+        float t = (duration > 0.0) ? elapsed / duration : 1.0;
+        vec2 position = paths.path[i]->atFraction(ease(easings, paths.easing[i], t));
+        animatic->rect.x = position.x;
+        animatic->rect.y = position.y;
+        return done;
+    });
+    for (TrackAnimations& playing : tracks) {stepTracks(playing, milliseconds);}
+
+    // Animations waiting behind finished queued ones start next update, like on a lone Animatic
+    for (int slot : released) {if (animatics[slot]) {release(slot);}}
+    released.clear();
+    // Every animation of a destroyed Animatic is gone now, so its slot is safe to reuse
+    freeSlots.insert(freeSlots.end(), destroyedSlots.begin(), destroyedSlots.end());
+    destroyedSlots.clear();
+}
+
+template <typename Animations, typename Step>
+void AnimaticWrapper::step(Animations& animations, const Step& stepOne)
+{
+    // Runs stepOne on every animation of one type (in chunks across the worker pool if parallel), then applies what the chunks collected
+    int count = animations.owner.size();
+    if (count == 0) {return;}
+    int perChunk = std::max(1, chunkSize);
+    int chunkCount = parallel ? (count + perChunk - 1) / perChunk : 1;
+    if (!parallel) {perChunk = count;}
+    if ((int)chunks.size() < chunkCount) {chunks.resize(chunkCount);} // Kept between updates, so their lists don't reallocate every frame
+    auto runChunk = [this, &stepOne, count, perChunk](int c)
+    {
+        Chunk& chunk = chunks[c];
+        chunk.done.clear();
+        chunk.commands.clear();
+        int end = std::min(count, (c + 1) * perChunk);
+        for (int i = c * perChunk; i < end; i++) {if (stepOne(i, chunk)) {chunk.done.push_back(i);}}
+    };
+    if (chunkCount == 1) {runChunk(0);}
+    else {sharedWorkerPool().parallelFor(chunkCount, runChunk);}
+
+    // Renderer calls, in the same order a serial update would make them
+    for (int c = 0; c < chunkCount; c++)
+    {
+        for (const RenderCommand& command : chunks[c].commands)
+        {
+            if (command.sheet == nullptr)
+            {
+                SDL_SetTextureAlphaMod(command.texture, command.alpha);
+                continue;
+            }
+            copyFrame(command.texture, command.sheet, command.frame);
+        }
+    }
+    // Swap-remove from the back, so every animation moved into a hole is one that is staying
+    for (int c = chunkCount - 1; c >= 0; c--)
+    {
+        const std::vector<int>& done = chunks[c].done;
+        for (int j = done.size() - 1; j >= 0; j--)
+        {
+            if (animations.queued[done[j]]) {released.push_back(animations.owner[done[j]]);}
+            removeAt(animations, done[j]);
+        }
+    }
+}
+
+void AnimaticWrapper::stepTracks(TrackAnimations& playing, double milliseconds)
+{
+    // Steps every track of one property. Each keyframe's easing is a table lookup, so a track costs about the same as a timed move
+    step(playing, [this, &playing, milliseconds](int i, Chunk& chunk)
+    {
+        Animatic* animatic = animatics[playing.owner[i]].get();
+        if (animatic == nullptr) {return true;}
+        const KeyframeTrack& track = *playing.track[i];
+        bool done = anim_track_advance(track, playing.elapsed[i], milliseconds, playing.loops[i]);
+        animatic->applyTrack(track.property, anim_track_value(track, playing.elapsed[i], playing.key[i]));
+        if (track.property == TRACK_ALPHA) {chunk.commands.push_back({animatic->texture, nullptr, {0, 0, 0, 0}, animatic->alpha});}
+        return done;
+    });
+}
+
+void AnimaticWrapper::renderAll()
+{
+    // Draws every Animatic through a SpriteBatch, so ones sharing a texture cost one draw call together
+    SDL_PROFILE_ZONE("AnimaticWrapper::renderAll");
+    if (!culling)
+    {
+        for (const std::unique_ptr<Animatic>& animatic : animatics) {if (animatic) {batch.add(animatic.get());}}
+        batch.render();
+        return;
+    }
+    cull();
+    SDL_Rect screen = view(0);
+    for (int slot : visibleSlots)
+    {
+        Animatic* animatic = animatics[slot].get();
+        if (SDL_HasIntersection(&animatic->rect, &screen)) {batch.add(animatic);}
+    }
+    // Anything that jumped into view while culled gets its current frame now, instead of on its next frame change
+    for (int i = 0; i < (int)spritesheets.owner.size(); i++)
+    {
+        int slot = spritesheets.owner[i];
+        if (!spritesheets.stale[i] || !places[slot].visible || !animatics[slot]) {continue;}
+        copyFrame(animatics[slot]->texture, spritesheets.sheet[i], spritesheets.frameRect[i]);
+        spritesheets.stale[i] = false;
+    }
+    batch.render();
+}
+
+void AnimaticWrapper::setCellSize(int size)
+{
+    // Sets the side of each culling grid cell in pixels. Everything is refiled on the next renderAll()
+    cellSize = std::max(1, size);
+    grid.clear();
+    for (GridPlace& place : places) {place.cell = NO_CELL;}
+}
+
+bool AnimaticWrapper::isVisible(Animatic* animatic)
+{
+    // Whether the last renderAll() found an Animatic in (or within cullMargin of) the viewport. Always true without culling
+    return !culling || places[animatic->wrapperSlot].visible;
+}
+
+int AnimaticWrapper::activeAnimations()
+{
+    // How many animations are ticking (not counting ones waiting behind a queued animation)
+    return spritesheets.owner.size() + moves.owner.size() + scales.owner.size() + fades.owner.size()
+        + timedMoves.owner.size() + timedScales.owner.size() + timedFades.owner.size()
+        + tracks[TRACK_POSITION].owner.size() + tracks[TRACK_SIZE].owner.size() + tracks[TRACK_ALPHA].owner.size() + paths.owner.size();
+}
+
+void AnimaticWrapper::activate(int slot, int handle, const Animation& anim)
+{
+    // Starts an animation playing. A queued one blocks everything added after it
+    HandleSlot& where = handles[handle];
+    int easing = (anim.easing >= 0 && anim.easing < (int)anim_easing_tables().size()) ? anim.easing : (int)EASE_LINEAR;
+    switch(anim.type) {
+    case ANIMATION_SPRITESHEET:
+        where.kind = KIND_SPRITESHEET;
+        where.position = spritesheets.owner.size();
+        spritesheets.push(slot, handle, anim);
+        if (anim.direct)
+        {
+            // Show the first frame straight away
+            animatics[slot]->texture = anim.sheet;
+            animatics[slot]->source = anim.frameRect;
+        }
+        break;
+    case ANIMATION_MOVE:
+        where.kind = anim.timed ? KIND_TIMED_MOVE : KIND_MOVE;
+        where.position = anim.timed ? timedMoves.owner.size() : moves.owner.size();
+        if (anim.timed) {timedMoves.push(slot, handle, anim.queued, anim.startPos, anim.targetPos, anim.duration, anim.elapsed, easing);}
+        else {moves.push(slot, handle, anim.queued, anim.currentPos, anim.targetPos, anim.deltaPos);}
+        break;
+    case ANIMATION_SCALE:
+        where.kind = anim.timed ? KIND_TIMED_SCALE : KIND_SCALE;
+        where.position = anim.timed ? timedScales.owner.size() : scales.owner.size();
+        if (anim.timed) {timedScales.push(slot, handle, anim.queued, anim.startScale, anim.targetScale, anim.duration, anim.elapsed, easing);}
+        else {scales.push(slot, handle, anim.queued, anim.currentScale, anim.targetScale, anim.deltaScale);}
+        break;
+    case ANIMATION_FADE:
+        where.kind = anim.timed ? KIND_TIMED_FADE : KIND_FADE;
+        where.position = anim.timed ? timedFades.owner.size() : fades.owner.size();
+        if (anim.timed) {timedFades.push(slot, handle, anim.queued, anim.startFade, anim.targetFade, anim.duration, anim.elapsed, easing);}
+        else {fades.push(slot, handle, anim);}
+        break;
+    case ANIMATION_PATH:
+        where.kind = KIND_PATH;
+        where.position = paths.owner.size();
+        paths.push(slot, handle, anim, easing);
+        break;
+    case ANIMATION_TRACK: {
+        TrackAnimations& playing = tracks[anim.track->property];
+        where.kind = KIND_TRACK_POSITION + anim.track->property;
+        where.position = playing.owner.size();
+        playing.push(slot, handle, anim);
+        break;
+    }
+    default:
+        freeHandle(handle);
+        return; // Nothing to play, so nothing to wait for either
+    }
+    if (anim.queued) {queues[slot].blocked = true;}
+}
+
+void AnimaticWrapper::copyFrame(SDL_Texture* texture, SDL_Texture* sheet, const SDL_Rect& frame)
+{
+    // Copies one spritesheet frame into an Animatic's texture
+    SDL_Texture* originalTexture = SDL_GetRenderTarget(sdl->renderer);
+    SDL_SetRenderTarget(sdl->renderer, texture);
+    SDL_SetRenderDrawColor(sdl->renderer, 0, 0, 0, 0);
+    SDL_SetRenderDrawBlendMode(sdl->renderer, SDL_BLENDMODE_NONE);
+    SDL_RenderClear(sdl->renderer);
+    SDL_RenderCopy(sdl->renderer, sheet, &frame, nullptr);
+    SDL_SetRenderTarget(sdl->renderer, originalTexture);
+}
+
+void AnimaticWrapper::cull()
+{
+    // Refiles moved Animatics in the grid, then marks the ones in the viewport (plus cullMargin) visible
+    // Refiling is a quick compare per Animatic. Only the cells under the viewport are searched
+    largest = {0, 0};
+    for (int slot = 0; slot < (int)animatics.size(); slot++)
+    {
+        Animatic* animatic = animatics[slot].get();
+        if (animatic == nullptr) {continue;}
+        largest.x = std::max(largest.x, animatic->rect.w);
+        largest.y = std::max(largest.y, animatic->rect.h);
+        long long cell = cellAt(animatic->rect.x, animatic->rect.y);
+        GridPlace& place = places[slot];
+        if (cell == place.cell) {continue;}
+        unfile(slot);
+        std::vector<int>& slots = grid[cell];
+        place.cell = cell;
+        place.index = slots.size();
+        slots.push_back(slot);
+    }
+
+    for (int slot : visibleSlots) {places[slot].visible = false;}
+    visibleSlots.clear();
+    SDL_Rect area = view(cullMargin);
+    // An Animatic is filed by its top left, so look up and left far enough to catch the biggest one reaching in
+    long long firstX = std::floor((double)(area.x - largest.x) / cellSize);
+    long long firstY = std::floor((double)(area.y - largest.y) / cellSize);
+    long long lastX = std::floor((double)(area.x + area.w) / cellSize);
+    long long lastY = std::floor((double)(area.y + area.h) / cellSize);
+    for (long long y = firstY; y <= lastY; y++)
+    {
+        for (long long x = firstX; x <= lastX; x++)
+        {
+            auto found = grid.find(cellKey(x, y));
+            if (found == grid.end()) {continue;}
+            for (int slot : found->second)
+            {
+                if (!SDL_HasIntersection(&animatics[slot]->rect, &area)) {continue;}
+                places[slot].visible = true;
+                visibleSlots.push_back(slot);
+            }
+        }
+    }
+    std::sort(visibleSlots.begin(), visibleSlots.end()); // Same draw order as without culling
+}
+
+void AnimaticWrapper::unfile(int slot)
+{
+    // Takes an Animatic out of its grid cell by moving the cell's last one into its place
+    GridPlace& place = places[slot];
+    if (place.cell == NO_CELL) {return;}
+    std::vector<int>& slots = grid[place.cell];
+    slots[place.index] = slots.back();
+    places[slots[place.index]].index = place.index;
+    slots.pop_back();
+    place.cell = NO_CELL;
+    place.index = -1;
+    place.visible = false;
+}
+
+SDL_Rect AnimaticWrapper::view(int margin)
+{
+    // The viewport (or window) grown by margin on every side
+    SDL_Rect area = viewport;
+    if (area.w <= 0 || area.h <= 0) {area = {0, 0, sdl->WIDTH, sdl->HEIGHT};}
+    return {area.x - margin, area.y - margin, area.w + margin * 2, area.h + margin * 2};
+}
+
+long long AnimaticWrapper::cellAt(int x, int y)
+{
+    // Key of the grid cell holding a point. Floors, so cells left of and above 0 work too
+    return cellKey(std::floor((double)x / cellSize), std::floor((double)y / cellSize));
+}
+
+long long AnimaticWrapper::cellKey(long long cellX, long long cellY)
+{
+    // Packs a cell's column and row into one key
+    return (long long)(((unsigned long long)cellX << 32) | ((unsigned long long)cellY & 0xffffffffULL));
+}
+
+void AnimaticWrapper::release(int slot)
+{
+    // Starts whatever was waiting behind a finished queued animation, up to and including the next queued one
+    Queue& queue = queues[slot];
+    queue.blocked = false;
+    while (!queue.blocked && queue.head != -1)
+    {
+        int node = queue.head;
+        queue.head = waitingNodes[node].next;
+        if (queue.head == -1) {queue.tail = -1;}
+        int handle = waitingNodes[node].handle;
+        waitingNodes[node].next = freeWaiting;
+        freeWaiting = node;
+        if (handle != -1) {activate(slot, handle, waitingNodes[node].anim);} // Skip cancelled ones
+    }
+}
+
+template <typename Animations>
+void AnimaticWrapper::removeAt(Animations& animations, int i)
+{
+    // Swap-removes animation i, keeping the handles pointing at the right places
+    int handle = animations.handle[i];
+    animations.remove(i);
+    if (i < (int)animations.handle.size()) {handles[animations.handle[i]].position = i;} // The one moved into i
+    freeHandle(handle);
+}
+
+int AnimaticWrapper::newHandle()
+{
+    // Takes a free HandleSlot
+    if (freeHandles == -1)
+    {
+        handles.emplace_back();
+        return handles.size() - 1;
+    }
+    int handle = freeHandles;
+    freeHandles = handles[handle].position;
+    return handle;
+}
+
+void AnimaticWrapper::freeHandle(int handle)
+{
+    // Returns a HandleSlot, so every handle to it stops matching
+    HandleSlot& slot = handles[handle];
+    slot.generation++;
+    slot.kind = KIND_FREE;
+    slot.position = freeHandles;
+    freeHandles = handle;
+}
+
+int AnimaticWrapper::ownerOf(const HandleSlot& handle)
+{
+    // Slot of the Animatic a playing animation is on
+    switch (handle.kind) {
+    case KIND_SPRITESHEET: return spritesheets.owner[handle.position];
+    case KIND_MOVE: return moves.owner[handle.position];
+    case KIND_SCALE: return scales.owner[handle.position];
+    case KIND_FADE: return fades.owner[handle.position];
+    case KIND_TIMED_MOVE: return timedMoves.owner[handle.position];
+    case KIND_TIMED_SCALE: return timedScales.owner[handle.position];
+    case KIND_TIMED_FADE: return timedFades.owner[handle.position];
+    case KIND_TRACK_POSITION:
+    case KIND_TRACK_SIZE:
+    case KIND_TRACK_ALPHA: return tracks[handle.kind - KIND_TRACK_POSITION].owner[handle.position];
+    case KIND_PATH: return paths.owner[handle.position];
+    default: return -1;
+    }
+}
+
+bool AnimaticWrapper::stepTowards(vec2& current, const vec2& target, const vec2& delta)
+{
+    // Moves current by delta without passing target. True once it's there
+    current.x += delta.x;
+    current.y += delta.y;
+    if ((delta.x >= 0.0 && current.x > target.x) || (delta.x < 0.0 && current.x < target.x)) {current.x = target.x;}
+    if ((delta.y >= 0.0 && current.y > target.y) || (delta.y < 0.0 && current.y < target.y)) {current.y = target.y;}
+    return current.x == target.x && current.y == target.y;
+}
+
+float AnimaticWrapper::ease(const EasingTable* easings, int easing, float t)
+{
+    // anim_ease without the table lookup. easing must be valid (activate() checks)
+    return (easing == EASE_LINEAR) ? t : anim_ease(easings[easing], t);
+}
+
+void AnimaticWrapper::SpritesheetAnimations::push(int slot, int handleIndex, const Animation& anim)
+{
+    owner.push_back(slot);
+    handle.push_back(handleIndex);
+    queued.push_back(anim.queued);
+    sheet.push_back(anim.sheet);
+    frameRect.push_back(anim.frameRect);
+    origin.push_back(anim.origin);
+    columns.push_back(anim.columns);
+    ticksPerFrame.push_back(anim.ticksPerFrame);
+    currentTicks.push_back(anim.currentTicks);
+    currentFrame.push_back(anim.currentFrame);
+    totalFrames.push_back(anim.totalFrames);
+    loops.push_back(anim.loops);
+    direct.push_back(anim.direct);
+    timed.push_back(anim.timed);
+    frameTime.push_back(anim.duration);
+    elapsed.push_back(anim.elapsed);
+    stale.push_back(false);
+}
+
+void AnimaticWrapper::SpritesheetAnimations::remove(int i)
+{
+    swapRemove(owner, i);
+    swapRemove(handle, i);
+    swapRemove(queued, i);
+    swapRemove(sheet, i);
+    swapRemove(frameRect, i);
+    swapRemove(origin, i);
+    swapRemove(columns, i);
+    swapRemove(ticksPerFrame, i);
+    swapRemove(currentTicks, i);
+    swapRemove(currentFrame, i);
+    swapRemove(totalFrames, i);
+    swapRemove(loops, i);
+    swapRemove(direct, i);
+    swapRemove(timed, i);
+    swapRemove(frameTime, i);
+    swapRemove(elapsed, i);
+    swapRemove(stale, i);
+}
+
+void AnimaticWrapper::VectorAnimations::push(int slot, int handleIndex, bool isQueued, vec2 start, vec2 end, vec2 step)
+{
+    owner.push_back(slot);
+    handle.push_back(handleIndex);
+    queued.push_back(isQueued);
+    current.push_back(start);
+    target.push_back(end);
+    delta.push_back(step);
+}
+
+void AnimaticWrapper::VectorAnimations::remove(int i)
+{
+    swapRemove(owner, i);
+    swapRemove(handle, i);
+    swapRemove(queued, i);
+    swapRemove(current, i);
+    swapRemove(target, i);
+    swapRemove(delta, i);
+}
+
+void AnimaticWrapper::FadeAnimations::push(int slot, int handleIndex, const Animation& anim)
+{
+    owner.push_back(slot);
+    handle.push_back(handleIndex);
+    queued.push_back(anim.queued);
+    current.push_back(anim.currentFade);
+    delta.push_back(anim.deltaFade);
+}
+
+void AnimaticWrapper::FadeAnimations::remove(int i)
+{
+    swapRemove(owner, i);
+    swapRemove(handle, i);
+    swapRemove(queued, i);
+    swapRemove(current, i);
+    swapRemove(delta, i);
+}
+
+void AnimaticWrapper::PathAnimations::push(int slot, int handleIndex, const Animation& anim, int curve)
+{
+    owner.push_back(slot);
+    handle.push_back(handleIndex);
+    queued.push_back(anim.queued);
+    path.push_back(anim.path);
+    duration.push_back(anim.duration);
+    elapsed.push_back(anim.elapsed);
+    easing.push_back(curve);
+    loops.push_back(anim.pathLoops);
+}
+
+void AnimaticWrapper::PathAnimations::remove(int i)
+{
+    swapRemove(owner, i);
+    swapRemove(handle, i);
+    swapRemove(queued, i);
+    swapRemove(path, i);
+    swapRemove(duration, i);
+    swapRemove(elapsed, i);
+    swapRemove(easing, i);
+    swapRemove(loops, i);
+}
+
+void AnimaticWrapper::TrackAnimations::push(int slot, int handleIndex, const Animation& anim)
+{
+    owner.push_back(slot);
+    handle.push_back(handleIndex);
+    queued.push_back(anim.queued);
+    track.push_back(anim.track);
+    elapsed.push_back(anim.elapsed);
+    key.push_back(anim.currentKey);
+    loops.push_back(anim.trackLoops);
+}
+
+void AnimaticWrapper::TrackAnimations::remove(int i)
 {
-    renderer = Renderer;
-}*/
\ No newline at end of file
+    swapRemove(owner, i);
+    swapRemove(handle, i);
+    swapRemove(queued, i);
+    swapRemove(track, i);
+    swapRemove(elapsed, i);
+    swapRemove(key, i);
+    swapRemove(loops, i);
+}
\ No newline at end of file
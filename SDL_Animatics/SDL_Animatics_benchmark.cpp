@@ -0,0 +1,190 @@
+/*
+Headless throughput benchmark for SDL_Animatics.h
+Runs on the dummy video driver with the software renderer, so it works without a display (CI, SSH, etc.)
+
+Build (from this folder):
+    g++ -std=c++11 -O2 -I../SDL_wrapper SDL_Animatics_benchmark.cpp -o SDL_Animatics_benchmark -lSDL2 -lSDL2_image -pthread
+Run:
+    ./SDL_Animatics_benchmark [frames]    (default 100 measured frames per test)
+
+For 1k, 10k and 100k Animatics, each playing a mixed chain (spritesheet, move, scale, fade), it times updating and rendering
+separately for lone Animatics, AnimaticWrapper, and AnimaticWrapper in parallel mode, and reports:
+    update ns/anim  - update time per playing animation
+    render ms/frame - drawing every Animatic and presenting
+    allocs/frame    - C++ heap allocations (operator new) during update + render
+    targets/frame   - SDL_SetRenderTarget calls during update + render
+*/
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Count render target switches by routing every SDL_SetRenderTarget in the headers below through here
+std::atomic<long long> renderTargetSwitches(0);
+int countedSetRenderTarget(SDL_Renderer* renderer, SDL_Texture* texture)
+{
+    renderTargetSwitches++;
+    return SDL_SetRenderTarget(renderer, texture);
+}
+#define SDL_SetRenderTarget countedSetRenderTarget
+
+#include "SDL_Animatics.h"
+
+#undef SDL_SetRenderTarget
+
+// Count heap allocations. Only C++ ones (SDL's own mallocs aren't seen)
+std::atomic<long long> allocations(0);
+void* operator new(std::size_t size)
+{
+    allocations++;
+    void* memory = std::malloc(size ? size : 1);
+    if (memory == nullptr) {throw std::bad_alloc();}
+    return memory;
+}
+void operator delete(void* memory) noexcept {std::free(memory);}
+
+enum Mode
+{
+    MODE_LONE,              // Every Animatic updated and drawn on its own
+    MODE_WRAPPER,           // AnimaticWrapper::updateAll() and renderAll()
+    MODE_WRAPPER_PARALLEL   // The same, with parallel set
+};
+
+struct Result
+{
+    double updateNsPerAnimation = 0.0;
+    double renderMsPerFrame = 0.0;
+    double allocationsPerFrame = 0.0;
+    double targetSwitchesPerFrame = 0.0;
+};
+
+typedef std::chrono::steady_clock benchClock;
+
+double elapsedMs(benchClock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(benchClock::now() - start).count();
+}
+
+void addChain(Animatic* animatic, AnimaticWrapper* wrapper, SDL_Texture* sheet, int i)
+{
+    // A mixed chain that keeps playing for the whole test. Lone Animatics use the render target spritesheet path, wrapped ones draw directly
+    bool direct = wrapper != nullptr;
+    float x = i % 1280;
+    float y = (i / 1280) % 800;
+    Animation chain[] = {
+        anim_spritesheet(sheet, 16, 16, 1 + i % 4, true, false, direct),
+        anim_move_timed({x, y}, {x + 64, y + 32}, 60000.0),
+        anim_scale({16, 16}, {48, 48}, 0.0005),
+        anim_fade(0.0, 0.0005)
+    };
+    for (const Animation& anim : chain)
+    {
+        if (wrapper != nullptr) {wrapper->addAnimation(animatic, anim);}
+        else {animatic->addAnimation(anim);}
+    }
+}
+
+Result run(SDL& sdl, Mode mode, int count, int frames)
+{
+    // Builds count Animatics, warms up, then measures frames frames
+    SDL_Texture* sheet = sdl.newBlankTexture(64, 16);
+    std::vector<SDL_Texture*> targets; // Lone Animatics copy frames into these. Shared round-robin, since only the cost matters here
+    for (int i = 0; i < 64; i++) {targets.push_back(sdl.newBlankTexture(16, 16));}
+
+    std::vector<Animatic*> lone;
+    AnimaticWrapper* wrapper = nullptr;
+    if (mode == MODE_LONE)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            lone.push_back(new Animatic(&sdl, targets[i % targets.size()]));
+            addChain(lone.back(), nullptr, sheet, i);
+        }
+    }
+    else
+    {
+        wrapper = new AnimaticWrapper(&sdl);
+        wrapper->parallel = (mode == MODE_WRAPPER_PARALLEL);
+        for (int i = 0; i < count; i++) {addChain(wrapper->create(sheet), wrapper, sheet, i);}
+    }
+
+    Result result;
+    double updateMs = 0.0;
+    double animationsUpdated = 0.0;
+    long long allocationsBefore = 0;
+    long long switchesBefore = 0;
+    const int warmup = 5;
+    for (int frame = 0; frame < warmup + frames; frame++)
+    {
+        if (frame == warmup)
+        {
+            allocationsBefore = allocations;
+            switchesBefore = renderTargetSwitches;
+        }
+        int playing = 0;
+        if (mode == MODE_LONE) {for (Animatic* animatic : lone) {playing += animatic->animations.size();}}
+        else {playing = wrapper->activeAnimations();}
+
+        benchClock::time_point start = benchClock::now();
+        if (mode == MODE_LONE) {for (Animatic* animatic : lone) {animatic->update(16.0);}}
+        else {wrapper->updateAll(16.0);}
+        double updateTime = elapsedMs(start);
+
+        start = benchClock::now();
+        sdl.clear();
+        if (mode == MODE_LONE) {for (Animatic* animatic : lone) {animatic->render();}}
+        else {wrapper->renderAll();}
+        sdl.update();
+        double renderTime = elapsedMs(start);
+
+        if (frame >= warmup)
+        {
+            updateMs += updateTime;
+            animationsUpdated += playing;
+            result.renderMsPerFrame += renderTime / frames;
+        }
+    }
+    result.updateNsPerAnimation = (animationsUpdated > 0.0) ? updateMs * 1000000.0 / animationsUpdated : 0.0;
+    result.allocationsPerFrame = (double)(allocations - allocationsBefore) / frames;
+    result.targetSwitchesPerFrame = (double)(renderTargetSwitches - switchesBefore) / frames;
+
+    for (Animatic* animatic : lone) {delete animatic;}
+    delete wrapper;
+    for (SDL_Texture* target : targets) {SDL_DestroyTexture(target);}
+    SDL_DestroyTexture(sheet);
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    int frames = (argc > 1) ? std::max(1, atoi(argv[1])) : 100;
+
+    // Headless: no window on screen, and the software renderer so no GPU is needed
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    SDL sdl("SDL_Animatics benchmark");
+    if (sdl.renderer == nullptr)
+    {
+        std::cout << "Unable to create a renderer! SDL Error: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    const char* modeNames[] = {"Animatic", "AnimaticWrapper", "AnimaticWrapper parallel"};
+    const int counts[] = {1000, 10000, 100000};
+    printf("%d measured frames per test, 16ms per update\n\n", frames);
+    printf("%-26s %8s %16s %16s %14s %14s\n", "mode", "count", "update ns/anim", "render ms/frame", "allocs/frame", "targets/frame");
+    for (int count : counts)
+    {
+        for (int mode = MODE_LONE; mode <= MODE_WRAPPER_PARALLEL; mode++)
+        {
+            Result result = run(sdl, (Mode)mode, count, frames);
+            printf("%-26s %8d %16.1f %16.3f %14.1f %14.1f\n", modeNames[mode], count, result.updateNsPerAnimation, result.renderMsPerFrame, result.allocationsPerFrame, result.targetSwitchesPerFrame);
+        }
+    }
+    return 0;
+}
@@ -3,6 +3,9 @@
 
 #include <SDL2/SDL.h> //For SDL...
 #include <map> // For maps (dictionaries)
+#include <cstring> // For memset
+#include <algorithm> // For std::max
+#include <vector> // For the parallel writer's pixel buffer
 #include "SDL_wrapper.h" // For loading / using optimized textures
 //#include "Universals.h" // For various things, including points
 
@@ -22,8 +25,32 @@ abcdefghijklmnopqrstuvwxyz
 /// VERSION 0.5
 /*
 Changelog:
-    -Planned-
-        Add bold and italics support in the same way colors are supported
+    -1.7-
+        Update for compatibility with new SDL_wrapper.h (1.10)
+        The writers, rasterizeBlock, and NumberDisplay::render are timed with SDL_PROFILE_ZONE (see SDL_profiler.h)
+    -1.6-
+        Update for compatibility with new SDL_wrapper.h (1.7)
+        Added the NumberDisplay class, a fast path for numbers that change every frame (scores, FPS, timers)
+            setInt(long long value), setFixed(long long value, int decimals), setFloat(double value, int decimals) - No strings, no allocation
+            render() - Draws the digits straight out of the font in one SDL_RenderGeometry call, with color, scale, and style
+    -1.5-
+        Update for compatibility with new SDL_wrapper.h (1.6)
+        Added SDL_Texture* writeBlockParallel(const std::string& block, char tokenizer = '#', char styleTokenizer = '^', int style = STYLE_REGULAR, int linesPerBand = 64)
+            Same output as writeBlockStyled, but rasterizes bands of lines on the shared WorkerPool into one buffer and uploads it once. For huge blocks that would otherwise hitch
+        rasterizeBlock() is safe to call from worker threads, it only reads shared font data
+    -1.4-
+        Added the StreamingText class, an output mode that never touches the render target
+            void write(const std::string& block, char tokenizer = '#', char styleTokenizer = '^', int style = STYLE_REGULAR) - Same tokens as writeBlockStyled, but writes character pixels into a reused streaming texture with SDL_LockTexture
+            Draw with the used part of the texture: SDL_RenderCopy(renderer, text.texture, &text.rect, &destination)
+        Added void rasterizeBlock(...) - writes a block of text straight into RGBA8888 pixels on the CPU
+        init() now builds the styled fonts on the CPU and keeps their pixels in styledFontSurfaces
+    -1.3-
+        Added bold and italics support in the same way colors are supported
+            init() now also builds bold, italic, and bold-italic copies of the font once, so styled text needs no extra passes or textures
+            SDL_Texture* writeLineStyled(const std::string& line, char tokenizer = '#', char styleTokenizer = '^', int style = STYLE_REGULAR) - Same as writeLineColor, but "^b" toggles bold, "^i" toggles italic, and "^r" resets to regular
+            SDL_Texture* writeBlockStyled(const std::string& block, char tokenizer = '#', char styleTokenizer = '^', int style = STYLE_REGULAR) - Same as writeBlockColor, with the styling of writeLineStyled. Style carries over between lines
+            int getMaximumLineLengthWithTokens(const std::string& block, char token = '#', char styleToken = '^') - utility function, ignores color and style sections when counting length
+        bold() and italic() still exist for styling already-made textures, but prefer the styled write functions
     -1.2.1-
         Update for compatibility with new SDL_wrapper.h (1.14)
         The fontpath is now specified dynamically when calling the new function: void init(SDL* newSDL, std::string pathToMonogram)!
@@ -265,15 +292,118 @@ namespace SDL_Text
     SDL* sdl = nullptr; // INITIALIZE TO MAIN SDL REFERENCE RENDERER BEFORE ANYTHING ELSE. YES I KNOW IS BAD FORM. This is so functions can be called like print("arg") without also passing renderer each time
     //int lookupX = 0; // Used for locating characters in the master image. Is set instead of the function returning anything
     //int lookupY = 0;
+    const int ATLAS_COLUMNS = 26; // Characters per row of monogram.png
+    const int ATLAS_ROWS = 4; // Rows of characters in monogram.png
+    const int STYLED_CHAR_WIDTH = CHAR_WIDTH + 3; // Width of a character cell in the styled fonts (room for bold +1 and italic +2)
+
+    enum TextStyle // Flags, so STYLE_BOLD | STYLE_ITALIC == STYLE_BOLD_ITALIC
+    {
+        STYLE_REGULAR = 0,
+        STYLE_BOLD = 1,
+        STYLE_ITALIC = 2,
+        STYLE_BOLD_ITALIC = 3
+    };
+    SDL_Texture* styledFonts[4] = {nullptr, nullptr, nullptr, nullptr}; // The font in every TextStyle, made once in init(). STYLE_REGULAR is just font
+    SDL_Surface* styledFontSurfaces[4] = {nullptr, nullptr, nullptr, nullptr}; // RGBA8888 pixels of styledFonts, used by the streaming writer
 
     /// Functions
 
+    int styleOverhang(int style)
+    {
+        // Returns how many pixels a character of this style spills past CHAR_WIDTH
+        return ((style & STYLE_BOLD) ? 1 : 0) + ((style & STYLE_ITALIC) ? 2 : 0);
+    }
+
+    int styleCharWidth(int style)
+    {
+        // Returns the width of a single character cell in the font of this style
+        return (style == STYLE_REGULAR) ? CHAR_WIDTH : STYLED_CHAR_WIDTH;
+    }
+
+    SDL_Surface* makeStyledFontSurface(SDL_Surface* source, int style)
+    {
+        // Returns a copy of the RGBA8888 font surface with every character bolded and/or italicized, laid out in STYLED_CHAR_WIDTH cells
+        // Does the same thing as bold() and italic(), but once per character at init instead of on every written texture
+        // Done on the CPU so the same surfaces can feed both the font textures and the streaming writer
+        SDL_Surface* styled = SDL_CreateRGBSurfaceWithFormat(0, STYLED_CHAR_WIDTH * ATLAS_COLUMNS, CHAR_HEIGHT * ATLAS_ROWS, 32, SDL_PIXELFORMAT_RGBA8888); // Starts all transparent
+        if (styled == nullptr) {return nullptr;}
+        int strikes = (style & STYLE_BOLD) ? 2 : 1; // Bold is the character drawn twice, 1 pixel apart
+
+        for (int row = 0; row < ATLAS_ROWS; row++)
+        {
+            for (int column = 0; column < ATLAS_COLUMNS; column++)
+            {
+                for (int y = 0; y < CHAR_HEIGHT; y++)
+                {
+                    // Italic slices, same as italic(): Top 3 pixels: right 2, Middle 4: right 1, Bottom 2: stay
+                    int shift = 0;
+                    if (style & STYLE_ITALIC) {shift = (y < 3) ? 2 : ((y < 7) ? 1 : 0);}
+                    const Uint32* sourceRow = (const Uint32*)((const Uint8*)source->pixels + (row * CHAR_HEIGHT + y) * source->pitch) + column * CHAR_WIDTH;
+                    Uint32* destRow = (Uint32*)((Uint8*)styled->pixels + (row * CHAR_HEIGHT + y) * styled->pitch) + column * STYLED_CHAR_WIDTH + shift;
+                    for (int x = 0; x < CHAR_WIDTH; x++)
+                    {
+                        for (int strike = 0; strike < strikes; strike++)
+                        {
+                            // Keep whichever strike is more opaque, the same as blending two white copies
+                            if ((sourceRow[x] & 0xFF) > (destRow[x + strike] & 0xFF)) {destRow[x + strike] = sourceRow[x];}
+                        }
+                    }
+                }
+            }
+        }
+        return styled;
+    }
+
+    void setFontColorMod(uint8_t r, uint8_t g, uint8_t b)
+    {
+        // Modulates the font in every style at once, so color survives style changes
+        for (SDL_Texture* styledFont : styledFonts)
+        {
+            SDL_SetTextureColorMod(styledFont, r, g, b);
+        }
+    }
+
     void init(SDL* newSDL, std::string pathToMonogram)
     {
         // Is slightly better form to initialize needed SDL instance
         fontpath = pathToMonogram;
         sdl = newSDL;
-        font = sdl->loadTexture(fontpath);
+
+        // Load the font once as RGBA8888 pixels, then build the styled copies from it instead of restyling every written texture
+        // Everything is built first and only swapped in if it all worked, so a bad path leaves any earlier font as it was
+        SDL_Surface* loadedSurface = loadSurface(fontpath); // Says why itself if it fails
+        if (loadedSurface == nullptr) {return;}
+        SDL_Surface* newSurfaces[4] = {nullptr, nullptr, nullptr, nullptr};
+        SDL_Texture* newFonts[4] = {nullptr, nullptr, nullptr, nullptr};
+        bool built = true;
+        for (int style = STYLE_REGULAR; style <= STYLE_BOLD_ITALIC && built; style++)
+        {
+            if (style == STYLE_REGULAR) {newSurfaces[style] = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_RGBA8888, 0);}
+            else {newSurfaces[style] = makeStyledFontSurface(newSurfaces[STYLE_REGULAR], style);}
+            if (newSurfaces[style] != nullptr) {newFonts[style] = SDL_CreateTextureFromSurface(sdl->renderer, newSurfaces[style]);}
+            if (newFonts[style] == nullptr) {built = false;}
+            else {SDL_SetTextureBlendMode(newFonts[style], SDL_BLENDMODE_BLEND);}
+        }
+        SDL_FreeSurface(loadedSurface);
+        if (!built)
+        {
+            std::cout << "Unable to build the font from " << fontpath << "! SDL Error: " << SDL_GetError() << std::endl;
+            for (int style = STYLE_REGULAR; style <= STYLE_BOLD_ITALIC; style++)
+            {
+                if (newFonts[style] != nullptr) {SDL_DestroyTexture(newFonts[style]);}
+                if (newSurfaces[style] != nullptr) {SDL_FreeSurface(newSurfaces[style]);}
+            }
+            return;
+        }
+        for (int style = STYLE_REGULAR; style <= STYLE_BOLD_ITALIC; style++)
+        {
+            // Clean up after any earlier init()
+            if (styledFonts[style] != nullptr) {SDL_DestroyTexture(styledFonts[style]);}
+            if (styledFontSurfaces[style] != nullptr) {SDL_FreeSurface(styledFontSurfaces[style]);}
+            styledFonts[style] = newFonts[style];
+            styledFontSurfaces[style] = newSurfaces[style];
+        }
+        font = styledFonts[STYLE_REGULAR];
     }
 
     int countLines(const std::string& block)
@@ -338,6 +468,55 @@ namespace SDL_Text
         return longest;
     }
 
+    int getMaximumLineLengthWithTokens(const std::string& block, char token = '#', char styleToken = '^')
+    {
+        // Same as getMaximumLineLengthWithColorToken, but also skips style sections ("^b", "^i", "^r") when counting
+        // Does not do any form of error checking. Do your own, please.
+
+        int longest = 0;
+        int current = 0;
+        for (char c : block)
+        {
+            if (c == '\n')
+            {
+                if (current > longest) {longest = current;}
+                current = 0;
+            }
+            else if (c == token)
+            {
+                current -= 6; // -7 + 1, same as above
+            }
+            else if (c == styleToken)
+            {
+                current -= 1; // -2 + 1
+            }
+            else
+            {
+                current++;
+            }
+        }
+        if (current > longest) {longest = current;}
+        return longest;
+    }
+
+    int getMaximumStyleOverhang(const std::string& block, char styleToken = '^', int style = STYLE_REGULAR)
+    {
+        // Returns how far the widest style used in the block spills past CHAR_WIDTH (what the styled writers add to their width)
+        int overhang = styleOverhang(style);
+        for (size_t i = 0; i + 1 < block.length(); i++)
+        {
+            if (block[i] == styleToken)
+            {
+                if (block[i+1] == 'b') {style ^= STYLE_BOLD;}
+                else if (block[i+1] == 'i') {style ^= STYLE_ITALIC;}
+                else if (block[i+1] == 'r') {style = STYLE_REGULAR;}
+                if (styleOverhang(style) > overhang) {overhang = styleOverhang(style);}
+                i++;
+            }
+        }
+        return overhang;
+    }
+
     SDL_Texture* bold(SDL_Texture* source, bool destructive = true)
     {
         // Returns the bold version of the given text texture. If destructive, destroys old texture
@@ -394,6 +573,7 @@ namespace SDL_Text
     SDL_Texture* writeLine (const std::string& line)
     {
         // Turns text into a texture. Also adds a pixel of space in between characters
+        SDL_PROFILE_ZONE("SDL_Text::writeLine");
         // Original target saving
         SDL_Texture* originalTarget = SDL_GetRenderTarget(sdl->renderer);
         // Source and destination rectangles
@@ -442,6 +622,7 @@ namespace SDL_Text
     {
         // Writes a block of text a single line at a time.
         // Uses the newline '\n' character to separate lines
+        SDL_PROFILE_ZONE("SDL_Text::writeBlock");
 
         // Variable init things
         SDL_Rect sourceRect = {0, 0, CHAR_WIDTH, CHAR_HEIGHT}; // The source rectangle for the text
@@ -600,6 +781,7 @@ namespace SDL_Text
         // e.g. "White#FF0000Red#FFFFFFWhite" will print the text the expected colors, but with no space between words...
         // Tokenizer can also be changed to something user-specified, but color is always 6-digit hexadecimal
         // No error checking within this function. Please do your own.
+        SDL_PROFILE_ZONE("SDL_Text::writeLineColor");
 
         // The current colors for the passage of text
         uint8_t r = 255;
@@ -669,6 +851,7 @@ namespace SDL_Text
         // Uses the newline '\n' character to separate lines
         // Also has color support. Color carries over between lines. See writeLineColor for more details
         // Does not have error checking! Please do your own!
+        SDL_PROFILE_ZONE("SDL_Text::writeBlockColor");
 
         // Color setup
         uint8_t r = 255;
@@ -745,6 +928,355 @@ namespace SDL_Text
         SDL_SetTextureBlendMode(blockTexture, SDL_BLENDMODE_BLEND);
         return blockTexture;
     }
+
+    SDL_Texture* writeBlockStyled(const std::string& block, char tokenizer = '#', char styleTokenizer = '^', int style = STYLE_REGULAR)
+    {
+        // All functionality of writeBlockColor, but can also change bold and italics within the text
+        // Style is changed by adding "^b" (toggle bold), "^i" (toggle italics), or "^r" (back to regular) before text
+        // e.g. "Regular ^bBold^i and italic^r regular" will print the text the expected styles
+        // Characters are copied straight from the styled fonts made in init(), so there are no extra passes like with bold() and italic()
+        // Color and style both carry over between lines. No error checking, please do your own!
+        SDL_PROFILE_ZONE("SDL_Text::writeBlockStyled");
+
+        // Color setup
+        uint8_t r = 255;
+        uint8_t g = 255;
+        uint8_t b = 255;
+
+        // Variable init things
+        SDL_Rect sourceRect = {0, 0, styleCharWidth(style), CHAR_HEIGHT}; // The source rectangle for the text
+        SDL_Rect destRect = {0, 0, styleCharWidth(style), CHAR_HEIGHT}; // The destination render rectangle
+        // Original target saving
+        SDL_Texture* originalTarget = SDL_GetRenderTarget(sdl->renderer);
+        // Make a new texture of the needed size
+        int width = getMaximumLineLengthWithTokens(block, tokenizer, styleTokenizer);
+        width = width * CHAR_WIDTH + width - 1 + getMaximumStyleOverhang(block, styleTokenizer, style); // For space in between chars (1 for each char, minus one after last char)
+        int height = countLines(block);
+        height = height * CHAR_HEIGHT + height - 1; // For space in between rows (1 for each char, minus one after last row)
+        SDL_Texture* blockTexture = SDL_CreateTexture(sdl->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        // Setup the texture with all transparent
+        SDL_SetRenderTarget(sdl->renderer, blockTexture);
+        SDL_SetRenderDrawBlendMode(sdl->renderer, SDL_BLENDMODE_NONE);
+        SDL_SetTextureBlendMode(blockTexture, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(sdl->renderer, 0, 0, 0, 0);
+        SDL_RenderClear(sdl->renderer);
+        // Iterate through all of the characters, drawing them to where they need to go
+        for (size_t i = 0; i < block.length(); i++)
+        {
+            if (block[i] == '\n')
+            {
+                // Newline things
+                destRect.x = 0;
+                destRect.y += CHAR_HEIGHT + 1;
+            }
+            else if (block[i] == tokenizer) // Beginning of color passage
+            {
+                // Determine the correct color
+                r = std::stoi(block.substr(i+1, 2), nullptr, 16);
+                g = std::stoi(block.substr(i+3, 2), nullptr, 16);
+                b = std::stoi(block.substr(i+5, 2), nullptr, 16);
+
+                // Modulate every styled font, so the color survives style changes
+                setFontColorMod(r, g, b);
+
+                // Advance i as needed to the next index of actual text
+                i += 6;
+            }
+            else if (block[i] == styleTokenizer) // Beginning of style passage
+            {
+                if (i + 1 < block.length())
+                {
+                    if (block[i+1] == 'b') {style ^= STYLE_BOLD;}
+                    else if (block[i+1] == 'i') {style ^= STYLE_ITALIC;}
+                    else if (block[i+1] == 'r') {style = STYLE_REGULAR;}
+                }
+                sourceRect.w = styleCharWidth(style);
+                destRect.w = sourceRect.w;
+
+                // Advance i past the style letter
+                i += 1;
+            }
+            else
+            {
+                if (characterLocation.count(block[i]) != 0) // If exists in map
+                {
+                    // Update the source rect
+                    sourceRect.x = characterLocation[block[i]].x * sourceRect.w;
+                    sourceRect.y = characterLocation[block[i]].y * CHAR_HEIGHT;
+                    // Write to destination
+                    SDL_RenderCopy(sdl->renderer, styledFonts[style], &sourceRect, &destRect);
+                } // All unknown characters are treated like spaces!
+
+                // Move the destRect
+                destRect.x += CHAR_WIDTH + 1;
+            }
+        }
+        // Cleanup and return
+        setFontColorMod(255, 255, 255); // Reset the source textures to all white
+        SDL_SetRenderTarget(sdl->renderer, originalTarget);
+        SDL_SetRenderDrawBlendMode(sdl->renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureBlendMode(blockTexture, SDL_BLENDMODE_BLEND);
+        return blockTexture;
+    }
+
+    SDL_Texture* writeLineStyled(const std::string& line, char tokenizer = '#', char styleTokenizer = '^', int style = STYLE_REGULAR)
+    {
+        // All functionality of writeLineColor, plus the bold and italics of writeBlockStyled (a line is just a one-line block)
+        return writeBlockStyled(line, tokenizer, styleTokenizer, style);
+    }
+
+    void rasterizeBlock(const std::string& block, Uint32* pixels, int pitch, int width, int height, char tokenizer = '#', char styleTokenizer = '^', int style = STYLE_REGULAR, uint8_t r = 255, uint8_t g = 255, uint8_t b = 255)
+    {
+        // Writes a block of text straight into RGBA8888 pixels (pitch is in bytes), clipped to width x height
+        // Same layout, colors, and styles as writeBlockStyled, but done on the CPU from styledFontSurfaces. Never touches the renderer
+        // Overlapping bold/italic neighbors composite the same way too: the later character is blended over the earlier one
+        // Expects the pixels to already be cleared to transparent
+        SDL_PROFILE_ZONE("SDL_Text::rasterizeBlock");
+        int penX = 0;
+        int penY = 0;
+        for (size_t i = 0; i < block.length(); i++)
+        {
+            if (block[i] == '\n')
+            {
+                // Newline things
+                penX = 0;
+                penY += CHAR_HEIGHT + 1;
+            }
+            else if (block[i] == tokenizer) // Beginning of color passage
+            {
+                r = std::stoi(block.substr(i+1, 2), nullptr, 16);
+                g = std::stoi(block.substr(i+3, 2), nullptr, 16);
+                b = std::stoi(block.substr(i+5, 2), nullptr, 16);
+                i += 6;
+            }
+            else if (block[i] == styleTokenizer) // Beginning of style passage
+            {
+                if (i + 1 < block.length())
+                {
+                    if (block[i+1] == 'b') {style ^= STYLE_BOLD;}
+                    else if (block[i+1] == 'i') {style ^= STYLE_ITALIC;}
+                    else if (block[i+1] == 'r') {style = STYLE_REGULAR;}
+                }
+                i += 1;
+            }
+            else
+            {
+                std::map<char, SDL_Point>::const_iterator location = characterLocation.find(block[i]);
+                if (location != characterLocation.end()) // If exists in the map
+                {
+                    // Copy the character cell over pixel by pixel, color modulating as we go
+                    SDL_Surface* source = styledFontSurfaces[style];
+                    int cellWidth = styleCharWidth(style);
+                    for (int y = 0; y < CHAR_HEIGHT && penY + y < height; y++)
+                    {
+                        const Uint32* sourceRow = (const Uint32*)((const Uint8*)source->pixels + (location->second.y * CHAR_HEIGHT + y) * source->pitch) + location->second.x * cellWidth;
+                        Uint32* destRow = (Uint32*)((Uint8*)pixels + (penY + y) * pitch) + penX;
+                        for (int x = 0; x < cellWidth && penX + x < width; x++)
+                        {
+                            Uint32 pixel = sourceRow[x];
+                            Uint32 alpha = pixel & 0xFF;
+                            if (alpha == 0) {continue;} // Transparent
+                            Uint32 red = ((pixel >> 24) & 0xFF) * r / 255;
+                            Uint32 green = ((pixel >> 16) & 0xFF) * g / 255;
+                            Uint32 blue = ((pixel >> 8) & 0xFF) * b / 255;
+                            if (alpha < 255)
+                            {
+                                // Later characters go over earlier ones with SDL_BLENDMODE_BLEND, exactly like SDL_RenderCopy onto writeBlockStyled's target
+                                Uint32 under = destRow[x];
+                                Uint32 inverse = 255 - alpha;
+                                red = (red * alpha + ((under >> 24) & 0xFF) * inverse) / 255;
+                                green = (green * alpha + ((under >> 16) & 0xFF) * inverse) / 255;
+                                blue = (blue * alpha + ((under >> 8) & 0xFF) * inverse) / 255;
+                                alpha = alpha + (under & 0xFF) * inverse / 255;
+                            }
+                            destRow[x] = (red << 24) | (green << 16) | (blue << 8) | alpha;
+                        }
+                    }
+                } // All unknown characters are treated like spaces!
+
+                penX += CHAR_WIDTH + 1;
+            }
+        }
+    }
+
+    SDL_Texture* writeBlockParallel(const std::string& block, char tokenizer = '#', char styleTokenizer = '^', int style = STYLE_REGULAR, int linesPerBand = 64)
+    {
+        // Same output as writeBlockStyled, but meant for huge blocks (thousands of lines) that would hitch a frame
+        // Splits the block into bands of lines, rasterizes each band on the shared WorkerPool into one CPU buffer, then uploads it once
+        // Color and style carry across bands exactly like they carry across lines. Still no error checking, do your own!
+        SDL_PROFILE_ZONE("SDL_Text::writeBlockParallel");
+
+        // Measure, same as writeBlockStyled
+        int width = getMaximumLineLengthWithTokens(block, tokenizer, styleTokenizer);
+        width = width * CHAR_WIDTH + width - 1 + getMaximumStyleOverhang(block, styleTokenizer, style);
+        int height = countLines(block);
+        height = height * CHAR_HEIGHT + height - 1;
+        if (width <= 0 || linesPerBand <= 0) {return nullptr;}
+
+        // Walk the tokens once (cheap, nothing is drawn) to find where each band starts and what color/style is active there
+        struct Band
+        {
+            int start; // Index into block of the first character
+            int end; // One past the last character
+            int line; // The line the band starts on
+            uint8_t r, g, b;
+            int style;
+        };
+        std::vector<Band> bands;
+        uint8_t r = 255;
+        uint8_t g = 255;
+        uint8_t b = 255;
+        int line = 0;
+        bands.push_back({0, (int)block.length(), 0, r, g, b, style});
+        for (size_t i = 0; i < block.length(); i++)
+        {
+            if (block[i] == '\n')
+            {
+                line++;
+                if (line % linesPerBand == 0)
+                {
+                    bands.back().end = (int)i; // The newline itself belongs to neither band
+                    bands.push_back({(int)i + 1, (int)block.length(), line, r, g, b, style});
+                }
+            }
+            else if (block[i] == tokenizer)
+            {
+                r = std::stoi(block.substr(i+1, 2), nullptr, 16);
+                g = std::stoi(block.substr(i+3, 2), nullptr, 16);
+                b = std::stoi(block.substr(i+5, 2), nullptr, 16);
+                i += 6;
+            }
+            else if (block[i] == styleTokenizer && i + 1 < block.length())
+            {
+                if (block[i+1] == 'b') {style ^= STYLE_BOLD;}
+                else if (block[i+1] == 'i') {style ^= STYLE_ITALIC;}
+                else if (block[i+1] == 'r') {style = STYLE_REGULAR;}
+                i += 1;
+            }
+        }
+
+        // Rasterize every band into its own rows of the shared buffer. Bands never overlap, so no locking is needed
+        std::vector<Uint32> pixels(width * height, 0);
+        int pitch = width * sizeof(Uint32);
+        sharedWorkerPool().parallelFor(bands.size(), [&](int index)
+        {
+            const Band& band = bands[index];
+            int top = band.line * (CHAR_HEIGHT + 1);
+            rasterizeBlock(block.substr(band.start, band.end - band.start), pixels.data() + top * width, pitch, width, height - top, tokenizer, styleTokenizer, band.style, band.r, band.g, band.b);
+        });
+
+        // Upload once
+        SDL_Texture* blockTexture = SDL_CreateTexture(sdl->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, width, height);
+        SDL_UpdateTexture(blockTexture, nullptr, pixels.data(), pitch);
+        SDL_SetTextureBlendMode(blockTexture, SDL_BLENDMODE_BLEND);
+        return blockTexture;
+    }
+
+    class StreamingText
+    {
+        // A reusable text output that writes character pixels into a streaming texture with SDL_LockTexture
+        // Unlike the write functions, it never switches the render target or changes blend mode / draw color, so updating text never stalls other rendering
+        // The texture only ever grows, so draw it with the used part: SDL_RenderCopy(renderer, text.texture, &text.rect, &destination)
+    public:
+        // Functions
+        StreamingText() {}
+        ~StreamingText() {SDL_DestroyTexture(texture);}
+        StreamingText(const StreamingText&) = delete; // Owns its texture
+        StreamingText& operator=(const StreamingText&) = delete;
+        void write(const std::string& block, char tokenizer = '#', char styleTokenizer = '^', int style = STYLE_REGULAR)
+        {
+            // Replaces the contents with a block of text. Takes the same tokens as writeBlockStyled
+            rect.w = getMaximumLineLengthWithTokens(block, tokenizer, styleTokenizer);
+            rect.w = rect.w * CHAR_WIDTH + rect.w - 1 + getMaximumStyleOverhang(block, styleTokenizer, style);
+            rect.h = countLines(block);
+            rect.h = rect.h * CHAR_HEIGHT + rect.h - 1;
+            if (rect.w <= 0) {rect.w = 0; return;} // Nothing to write
+
+            // Only make a new texture when the text outgrows the current one, doubling so steadily growing text rarely reallocates
+            if (rect.w > capacityWidth || rect.h > capacityHeight)
+            {
+                if (rect.w > capacityWidth) {capacityWidth = std::max(rect.w, capacityWidth * 2);}
+                if (rect.h > capacityHeight) {capacityHeight = std::max(rect.h, capacityHeight * 2);}
+                SDL_DestroyTexture(texture);
+                texture = SDL_CreateTexture(sdl->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, capacityWidth, capacityHeight);
+                SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+            }
+
+            // Locked pixels are write-only, so clear the used part before writing
+            void* pixels = nullptr;
+            int pitch = 0;
+            if (SDL_LockTexture(texture, &rect, &pixels, &pitch) != 0)
+            {
+                std::cout << "Cannot lock streaming text texture: " << SDL_GetError() << std::endl;
+                return;
+            }
+            for (int y = 0; y < rect.h; y++)
+            {
+                memset((Uint8*)pixels + y * pitch, 0, rect.w * sizeof(Uint32));
+            }
+            rasterizeBlock(block, (Uint32*)pixels, pitch, rect.w, rect.h, tokenizer, styleTokenizer, style);
+            SDL_UnlockTexture(texture);
+        }
+        // Variables
+        SDL_Texture* texture = nullptr; // The streaming texture. May be bigger than the text, see rect
+        SDL_Rect rect = {0, 0, 0, 0}; // The part of texture actually holding text
+    private:
+        // Variables
+        int capacityWidth = 0; // Size of texture
+        int capacityHeight = 0;
+    };
+
+    class NumberDisplay
+    {
+        // A fast path for numbers that change every frame (scores, FPS readouts, timers), drawn straight out of the font in one geometry call
+        // No texture is made and nothing is formatted into strings, so changing the value at any rate costs next to nothing
+        // Each character is CHAR_WIDTH x CHAR_HEIGHT times scale, with the usual 1 (scaled) pixel of space in between
+    public:
+        // Functions
+        NumberDisplay()
+        {
+            // Look up the strip of characters once
+            for (int i = 0; i < NumberStrip::SIZE; i++) {stripLocation[i] = characterLocation[NumberStrip::character(i)];}
+            setInt(0);
+        }
+        void setInt(long long value) {setFixed(value, 0);}
+        void setFloat(double value, int decimals) {setFixed(NumberStrip::roundFixed(value, decimals), decimals);} // Rounds to the given number of decimals, then shows it like setFixed
+        void setFixed(long long value, int decimals) {number.setFixed(value, decimals);} // Shows a fixed-point value: setFixed(12345, 2) shows "123.45"
+        void render()
+        {
+            // Draws the number at rect.x, rect.y. Quads are refilled every time (at most 32), so color, scale, style, and position can change freely
+            SDL_PROFILE_ZONE("NumberDisplay::render");
+            int length = number.length;
+            rect.w = (length * (CHAR_WIDTH + 1) - 1 + styleOverhang(style)) * scale;
+            rect.h = CHAR_HEIGHT * scale;
+            int cellWidth = styleCharWidth(style);
+            float invWidth = 1.0f / (cellWidth * ATLAS_COLUMNS);
+            float invHeight = 1.0f / (CHAR_HEIGHT * ATLAS_ROWS);
+            for (int i = 0; i < length; i++)
+            {
+                const SDL_Point& location = stripLocation[number.strip[i]];
+                float left = rect.x + i * (CHAR_WIDTH + 1) * scale;
+                float top = rect.y;
+                float right = left + cellWidth * scale;
+                float bottom = top + CHAR_HEIGHT * scale;
+                float u0 = location.x * cellWidth * invWidth;
+                float v0 = location.y * CHAR_HEIGHT * invHeight;
+                float u1 = (location.x + 1) * cellWidth * invWidth;
+                float v1 = (location.y + 1) * CHAR_HEIGHT * invHeight;
+                number.setQuad(i, left, top, right, bottom, u0, v0, u1, v1, color);
+            }
+            if (length > 0) {SDL_RenderGeometry(sdl->renderer, styledFonts[style], number.vertices, length * 4, number.indices, length * 6);}
+        }
+        // Variables
+        SDL_Rect rect = {0, 0, 0, 0}; // Set x and y to move it. w and h are filled in by render()
+        SDL_Color color = {255, 255, 255, 255};
+        int scale = 1; // Whole-number scale, since the font is pixel art
+        int style = STYLE_REGULAR;
+    private:
+        // Variables
+        NumberStrip number; // The current number and its quads
+        SDL_Point stripLocation[NumberStrip::SIZE]; // Where each strip character is in the font
+    };
 }
 
 #endif // SDL_TEXT_WRAPPER_H_INCLUDED
@@ -1,46 +1,424 @@
 #pragma once
 
 #include <SDL2/SDL_ttf.h>
+#include <map> // For the glyph atlas and font caches
+#include <memory> // For shared font handles
+#include <tuple>
+#include <mutex> // For async Text updates
+#include <deque>
+#include <list> // For the text size cache
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <algorithm> // For std::min and std::max
 #include "Universals.h" // Should define an SDL instance with variable name "sdl"
 
-class SDL_TTF
+inline void releaseGlyphAtlases(TTF_Font* font); // See below
+inline void releaseTextMetrics(TTF_Font* font);
+
+inline std::map<TTF_Font*, std::unique_ptr<std::mutex>>& fontMutexes()
 {
-    // Manages everything for SDL_TTF loading and unloading
+    // Every font's lock, made the first time it's asked for. Lock fontMutexesMutex() to use
+    // Never destroyed (like the other registries async jobs reach), since the worker pool can still be finishing jobs while statics are torn down at exit
+    static std::map<TTF_Font*, std::unique_ptr<std::mutex>>* mutexes = new std::map<TTF_Font*, std::unique_ptr<std::mutex>>();
+    return *mutexes;
+}
+
+inline std::mutex& fontMutexesMutex()
+{
+    static std::mutex* mutex = new std::mutex();
+    return *mutex;
+}
+
+inline std::mutex& fontMutex(TTF_Font* font)
+{
+    // Returns the lock for a font. TTF_Fonts can't be used from two threads at once, so lock this around any TTF call that could overlap with an async Text update
+    // Finding it takes a global lock, so anything that locks a font often should look this up once and keep the pointer
+    std::lock_guard<std::mutex> lock(fontMutexesMutex());
+    std::unique_ptr<std::mutex>& fontLock = fontMutexes()[font];
+    if (!fontLock) {fontLock.reset(new std::mutex());}
+    return *fontLock;
+}
+
+inline void releaseFontMutex(TTF_Font* font)
+{
+    // Forgets the font's lock. Call once the font is closed, so a later font at the same address gets a lock of its own
+    std::lock_guard<std::mutex> lock(fontMutexesMutex());
+    fontMutexes().erase(font);
+}
+
+class FontCache
+{
+    // Process-wide cache of open fonts, keyed by (canonical path, point size, style). Get it with fontCache()
+    // Handles are refcounted: the font closes when the last handle goes away, each font file is read from disk once and shared
+    // by every size/style opened from it, and SDL_ttf is initialized once for as long as any font is open
+    // Safe to use from any thread, but the last handle to a font should be dropped on the render thread, since closing it destroys its glyph atlases
 public:
     // Functions
-    SDL_TTF(std::string fontpath, int fontSize)
+    std::shared_ptr<TTF_Font> open(const std::string& fontpath, int pointSize, int style = TTF_STYLE_NORMAL)
     {
-        init_ttf();
-        font = TTF_OpenFont(fontpath.c_str(), fontSize);
+        // Returns a shared handle to the font, only opening it if nobody has it open already. Empty handle on failure
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string path = canonicalPath(fontpath); // So "a/../f.ttf" and "f.ttf" share one font
+        std::tuple<std::string, int, int> key(path, pointSize, style);
+        std::shared_ptr<TTF_Font> font;
+        std::map<std::tuple<std::string, int, int>, std::weak_ptr<TTF_Font>>::iterator foundFont = fonts.find(key);
+        if (foundFont != fonts.end())
+        {
+            font = foundFont->second.lock();
+            if (font) {return font;}
+            fonts.erase(foundFont); // Closed since
+        }
+
+        std::shared_ptr<TTFLibrary> ttf = library.lock();
+        if (!ttf)
+        {
+            ttf = std::make_shared<TTFLibrary>();
+            library = ttf;
+        }
+        std::shared_ptr<FontFile> file;
+        std::map<std::string, std::weak_ptr<FontFile>>::iterator foundFile = files.find(path);
+        if (foundFile != files.end())
+        {
+            file = foundFile->second.lock();
+            if (!file) {files.erase(foundFile);}
+        }
+        if (!file)
+        {
+            file = std::make_shared<FontFile>();
+            file->data = SDL_LoadFile(path.c_str(), &file->size);
+            if (file->data == nullptr)
+            {
+                std::cout << "Unable to load font " << fontpath << "! SDL Error: " << SDL_GetError() << std::endl;
+                return font;
+            }
+            files[path] = file;
+        }
+
+        // The font reads straight from the shared bytes (freesrc = 1 only frees the RWops, not the bytes)
+        TTF_Font* opened = TTF_OpenFontRW(SDL_RWFromConstMem(file->data, file->size), 1, pointSize);
+        if (opened == nullptr)
+        {
+            std::cout << "Unable to open font " << fontpath << "! SDL_ttf Error: " << TTF_GetError() << std::endl;
+            return font;
+        }
+        TTF_SetFontStyle(opened, style);
+        // The deleter holds the file and library alive until the font is closed, then lets them go (in that order)
+        font = std::shared_ptr<TTF_Font>(opened, [file, ttf](TTF_Font* closing) mutable
+        {
+            releaseGlyphAtlases(closing);
+            releaseTextMetrics(closing);
+            TTF_CloseFont(closing);
+            releaseFontMutex(closing);
+            file.reset();
+            ttf.reset();
+        });
+        fonts[key] = font;
+        handles[opened] = font;
+        prune();
+        return font;
     }
-    ~SDL_TTF()
+    std::shared_ptr<TTF_Font> share(TTF_Font* font)
     {
-        TTF_CloseFont(font);
-        TTF_Quit();
+        // Returns a handle that keeps font open, if it came from this cache and is still open
+        // Otherwise a handle that doesn't own it, in which case whoever opened it must keep it open
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<TTF_Font*, std::weak_ptr<TTF_Font>>::iterator found = handles.find(font);
+        std::shared_ptr<TTF_Font> handle;
+        if (found != handles.end()) {handle = found->second.lock();}
+        if (!handle) {handle = std::shared_ptr<TTF_Font>(font, [](TTF_Font*) {});}
+        return handle;
     }
-    //Text* write(std::string text)
+    int openFonts()
+    {
+        // Returns how many distinct fonts are currently open
+        std::lock_guard<std::mutex> lock(mutex);
+        prune();
+        return fonts.size();
+    }
+private:
+    // Functions
+    void prune()
+    {
+        // Forgets entries whose last handle has gone away
+        for (auto it = fonts.begin(); it != fonts.end(); ) {if (it->second.expired()) {it = fonts.erase(it);} else {++it;}}
+        for (auto it = files.begin(); it != files.end(); ) {if (it->second.expired()) {it = files.erase(it);} else {++it;}}
+        for (auto it = handles.begin(); it != handles.end(); ) {if (it->second.expired()) {it = handles.erase(it);} else {++it;}}
+    }
+    // Types
+    struct TTFLibrary
+    {
+        // SDL_ttf itself. Initialized while any font is open
+        TTFLibrary()
+        {
+            if (TTF_Init() == -1) {std::cout << "Failed to initialize SDL_ttf!" << std::endl;}
+        }
+        ~TTFLibrary() {TTF_Quit();}
+    };
+    struct FontFile
+    {
+        // The raw bytes of a font file, shared by every size and style opened from it
+        void* data = nullptr;
+        size_t size = 0;
+        ~FontFile() {SDL_free(data);}
+    };
     // Variables
-    TTF_Font* font = nullptr;
+    std::map<std::tuple<std::string, int, int>, std::weak_ptr<TTF_Font>> fonts;
+    std::map<std::string, std::weak_ptr<FontFile>> files;
+    std::map<TTF_Font*, std::weak_ptr<TTF_Font>> handles; // The same fonts, by pointer, for share()
+    std::weak_ptr<TTFLibrary> library;
+    std::mutex mutex; // Guards everything above
+};
+
+inline FontCache& fontCache()
+{
+    // The process-wide font cache, made on first use
+    static FontCache cache;
+    return cache;
+}
+
+class TextMetrics
+{
+    // Measures text without rasterizing it, for layout code that only needs to know how big a string will be
+    // Glyph metrics and kerning pairs are asked of SDL_ttf once each and kept, so a width is just a sum
+    // Optionally also remembers the size of the last few whole strings (setCacheCapacity), for UIs that measure the same labels every frame
+    // Get the shared one for a font with getTextMetrics(font). Safe to use from worker threads
+public:
+    // Functions
+    TextMetrics(TTF_Font* baseFont, int fontStyle)
+    {
+        font = baseFont;
+        style = fontStyle;
+        fontLock = &fontMutex(font);
+        std::lock_guard<std::mutex> lock(*fontLock);
+        height = TTF_FontHeight(font);
+    }
+    SDL_Point measure(const std::string& text)
+    {
+        // Returns the width (x) and height (y) of the text on one line, like TTF_SizeText would
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cacheCapacity > 0)
+        {
+            std::unordered_map<std::string, std::list<CachedSize>::iterator>::iterator found = cacheIndex.find(text);
+            if (found != cacheIndex.end())
+            {
+                recent.splice(recent.begin(), recent, found->second); // Now the most recently used
+                return found->second->size;
+            }
+        }
+        SDL_Point size = {lineWidth(text), height};
+        if (cacheCapacity > 0)
+        {
+            recent.push_front({text, size});
+            cacheIndex[text] = recent.begin();
+            trim();
+        }
+        return size;
+    }
+    int width(const std::string& text) {return measure(text).x;}
+    int getHeight() {return height;}
+    int advance(unsigned char character)
+    {
+        // Returns how far the pen moves past the character, not counting kerning
+        std::lock_guard<std::mutex> lock(mutex);
+        return glyph(character).advance;
+    }
+    int kerning(unsigned char previous, unsigned char character)
+    {
+        // Returns the extra pen movement between two characters
+        std::lock_guard<std::mutex> lock(mutex);
+        return pair(previous, character);
+    }
+    void setCacheCapacity(int strings)
+    {
+        // How many whole-string sizes to remember. 0 (the default) turns the cache off
+        std::lock_guard<std::mutex> lock(mutex);
+        cacheCapacity = std::max(0, strings);
+        trim();
+    }
+    // Variables
+    TTF_Font* font = nullptr; // The font being measured
+    int style = TTF_STYLE_NORMAL; // The TTF style it is measured with
 private:
+    // Types
+    struct GlyphMetrics
+    {
+        int minX = 0; // Left edge of the glyph relative to the pen. Negative if it hangs left
+        int maxX = 0; // Right edge of the glyph relative to the pen
+        int advance = 0;
+        bool loaded = false;
+    };
+    struct CachedSize
+    {
+        std::string text;
+        SDL_Point size;
+    };
     // Functions
-    bool init_ttf()
+    int lineWidth(const std::string& text)
     {
-        // Does all of the necessary starting things
-        //Initialize SDL_ttf
-        if (TTF_Init() == -1)
+        // Walks the pen across the text the same way GlyphAtlas::layout does, tracking how far ink reaches either way
+        int penX = 0;
+        int left = 0;
+        int right = 0;
+        unsigned char previous = 0;
+        for (char c : text)
         {
-            std::cout << "Failed to initialize SDL_ttf!" << std::endl;
-            return false;    
+            unsigned char character = c;
+            const GlyphMetrics& metrics = glyph(character);
+            penX += pair(previous, character);
+            left = std::min(left, penX + metrics.minX);
+            right = std::max(right, penX + metrics.maxX);
+            penX += metrics.advance;
+            previous = character;
         }
-        return true;
+        return std::max(right, penX) - left;
+    }
+    const GlyphMetrics& glyph(unsigned char character)
+    {
+        // Returns the metrics of the character, asking SDL_ttf the first time
+        GlyphMetrics& metrics = glyphs[character];
+        if (metrics.loaded || character == 0) {return metrics;}
+        metrics.loaded = true;
+        std::lock_guard<std::mutex> lock(*fontLock);
+        int originalStyle = TTF_GetFontStyle(font);
+        TTF_SetFontStyle(font, style);
+        if (TTF_GlyphMetrics(font, character, &metrics.minX, &metrics.maxX, nullptr, nullptr, &metrics.advance) != 0) {metrics = GlyphMetrics(); metrics.loaded = true;}
+        TTF_SetFontStyle(font, originalStyle);
+        return metrics;
+    }
+    int pair(unsigned char previous, unsigned char character)
+    {
+        // Returns the kerning between two characters, asking SDL_ttf the first time. The table is only made once kerning is needed
+        if (previous == 0 || character == 0) {return 0;}
+        if (kerningPairs.empty()) {kerningPairs.assign(256 * 256, short(UNKNOWN_KERNING));}
+        short& kern = kerningPairs[previous * 256 + character];
+        if (kern == UNKNOWN_KERNING)
+        {
+            std::lock_guard<std::mutex> lock(*fontLock);
+            int originalStyle = TTF_GetFontStyle(font);
+            TTF_SetFontStyle(font, style);
+            kern = TTF_GetFontKerningSizeGlyphs(font, previous, character);
+            TTF_SetFontStyle(font, originalStyle);
+        }
+        return kern;
+    }
+    void trim()
+    {
+        // Forgets the least recently used sizes until the cache fits
+        while ((int)recent.size() > cacheCapacity)
+        {
+            cacheIndex.erase(recent.back().text);
+            recent.pop_back();
+        }
+    }
+    // Variables
+    static const short UNKNOWN_KERNING = -32768;
+    std::mutex mutex; // Guards everything below
+    std::mutex* fontLock = nullptr; // fontMutex(font), looked up once
+    int height = 0; // TTF_FontHeight of the font
+    GlyphMetrics glyphs[256]; // Text is 8-bit, so every glyph fits in a flat table
+    std::vector<short> kerningPairs; // 256 x 256, indexed [previous * 256 + character]. UNKNOWN_KERNING until asked for
+    int cacheCapacity = 0;
+    std::list<CachedSize> recent; // Whole-string sizes, most recently used first
+    std::unordered_map<std::string, std::list<CachedSize>::iterator> cacheIndex; // Finds a string in recent
+};
+
+inline std::map<std::pair<TTF_Font*, int>, std::unique_ptr<TextMetrics>>& textMetrics()
+{
+    // Every TextMetrics made so far, keyed by font (which includes its size) and style. Lock textMetricsMutex() to use
+    // Never destroyed, since a font closed by an async job at exit still releases its metrics here
+    static std::map<std::pair<TTF_Font*, int>, std::unique_ptr<TextMetrics>>* metrics = new std::map<std::pair<TTF_Font*, int>, std::unique_ptr<TextMetrics>>();
+    return *metrics;
+}
+
+inline std::mutex& textMetricsMutex()
+{
+    static std::mutex* mutex = new std::mutex();
+    return *mutex;
+}
+
+inline TextMetrics* getTextMetrics(TTF_Font* font)
+{
+    // Returns the shared measurer for the font at its current style, making it the first time
+    int style = 0;
+    {
+        std::lock_guard<std::mutex> lock(fontMutex(font));
+        style = TTF_GetFontStyle(font);
+    }
+    std::lock_guard<std::mutex> lock(textMetricsMutex());
+    std::unique_ptr<TextMetrics>& metrics = textMetrics()[std::make_pair(font, style)];
+    if (!metrics) {metrics.reset(new TextMetrics(font, style));}
+    return metrics.get();
+}
+
+inline void releaseTextMetrics(TTF_Font* font)
+{
+    // Destroys every TextMetrics made for this font. Must be called before the font is closed
+    std::lock_guard<std::mutex> lock(textMetricsMutex());
+    std::map<std::pair<TTF_Font*, int>, std::unique_ptr<TextMetrics>>& metrics = textMetrics();
+    for (auto it = metrics.begin(); it != metrics.end(); ) {if (it->first.first == font) {it = metrics.erase(it);} else {++it;}}
+}
+
+class SDL_TTF
+{
+    // Manages everything for SDL_TTF loading and unloading
+    // Fonts come from the shared fontCache(), so making several SDL_TTFs of the same font is cheap, and destroying one never closes SDL_ttf for the others
+public:
+    // Functions
+    SDL_TTF(std::string fontpath, int fontSize, int fontStyle = TTF_STYLE_NORMAL)
+    {
+        handle = fontCache().open(fontpath, fontSize, fontStyle);
+        font = handle.get();
     }
+    SDL_Point measure(const std::string& text) {return getTextMetrics(font)->measure(text);} // Size of the text on one line, without rendering it
+    int width(const std::string& text) {return getTextMetrics(font)->width(text);}
+    //Text* write(std::string text)
     // Variables
+    TTF_Font* font = nullptr;
+private:
+    // Variables
+    std::shared_ptr<TTF_Font> handle; // Keeps font open for as long as this exists
+};
+
+class Text;
+
+struct AsyncTextState
+{
+    // What an async Text update shares with its worker job. Refcounted, so a Text can be destroyed while its job is still running
+    std::mutex mutex;
+    Text* owner = nullptr; // The Text to hand finished textures to. nullptr once that Text is gone
+    unsigned requested = 0; // Serial of the newest update asked for. Older results are thrown away
+    unsigned finished = 0; // Serial of surface
+    SDL_Surface* surface = nullptr; // Rasterized, waiting for upload on the render thread
+    bool ready = false; // Whether a finished result is waiting for upload. Can be with a null surface, when the new text is empty
+    bool queued = false; // Whether this is already waiting in the upload queue
+    ~AsyncTextState() {SDL_FreeSurface(surface);}
 };
 
+struct TextUploadQueue
+{
+    // Async Texts with a finished surface, in the order they finished
+    std::mutex mutex;
+    std::deque<std::shared_ptr<AsyncTextState>> ready;
+    std::vector<std::shared_ptr<TTF_Font>> fonts; // Font handles finished jobs let go of. uploadTextSurfaces() drops them, so a font never closes on a worker
+};
+
+inline TextUploadQueue& textUploadQueue()
+{
+    // Never destroyed. sharedWorkerPool() is often made first, so it's destroyed last, and it still finishes queued async jobs at exit
+    static TextUploadQueue* queue = new TextUploadQueue();
+    return *queue;
+}
+
+inline int uploadTextSurfaces(int budget = 4); // See below
+
 class Text
 {
     // A very basic wrapper class for single text textures. Make lots
-    // FEATURES: only updates when text changes
+    // FEATURES: only updates when text (or textColor) changes, and reuses its texture while the text still fits
+    // The texture is usually bigger than the text, and only its source rect holds the text. Draw with render(), or SDL_RenderCopy(sdl.renderer, text.getTexture(), &text.source, &text.rect)
+    // (texture used to be public and exactly the size of the text. It's private now so code drawing all of it with a nullptr source fails to compile instead of drawing garbage)
+    // setTextAsync() rasterizes on the shared WorkerPool instead, keeping the old texture visible until uploadTextSurfaces() swaps the new one in
 public:
     // Functions
     Text(TTF_Font* baseFont, const std::string& initialText)
@@ -48,23 +426,877 @@ public:
         font = baseFont;
         setText(initialText);
     }
+    Text(const Text& other) : textColor(other.textColor), rect(other.rect), font(other.font)
+    {
+        // Copies render their own texture (it gets updated in place, so it can't be shared) and never share async updates
+        setText(other.text);
+    }
+    Text(Text&& other) noexcept : textColor(other.textColor), rect(other.rect), font(other.font)
+    {
+        // Takes over the texture (and any async update) instead of rendering again, so growing a std::vector<Text> is cheap
+        takeFrom(other);
+    }
+    Text& operator=(const Text& other)
+    {
+        if (this == &other) {return *this;}
+        cancelAsync();
+        textColor = other.textColor;
+        rect = other.rect;
+        font = other.font;
+        setText(other.text);
+        return *this;
+    }
+    Text& operator=(Text&& other) noexcept
+    {
+        if (this == &other) {return *this;}
+        detach();
+        SDL_DestroyTexture(texture);
+        textColor = other.textColor;
+        rect = other.rect;
+        font = other.font;
+        takeFrom(other);
+        return *this;
+    }
+    ~Text()
+    {
+        detach();
+        SDL_DestroyTexture(texture);
+    }
     std::string& getText() {return text;} // So that we can't change it without updating
     void setText(const std::string& newText)
     {
+        if (isUnchanged(newText)) {return;}
         text = newText;
-        SDL_DestroyTexture(texture);
-        SDL_Surface* messageS = TTF_RenderText_Solid(font, text.c_str(), textColor);
-        texture = SDL_CreateTextureFromSurface(sdl.renderer, messageS);
+        cancelAsync(); // This is newer than anything still rasterizing
+        SDL_Surface* messageS = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(fontMutex(font));
+            messageS = TTF_RenderText_Solid(font, text.c_str(), textColor);
+        }
+        renderedColor = textColor;
+        uploadSurface(messageS);
         SDL_FreeSurface(messageS);
-        SDL_QueryTexture(texture, nullptr, nullptr, &rect.w, &rect.h);
     }
+    void setTextAsync(const std::string& newText)
+    {
+        // Same as setText, but rasterizes on a worker thread. texture and rect keep the old text until uploadTextSurfaces() gets to this one
+        // getText() returns the new text straight away
+        if (isUnchanged(newText)) {return;}
+        text = newText;
+        renderedColor = textColor;
+        if (!async)
+        {
+            async = std::make_shared<AsyncTextState>();
+            async->owner = this;
+        }
+        unsigned serial;
+        {
+            std::lock_guard<std::mutex> lock(async->mutex);
+            serial = ++async->requested;
+        }
+        std::shared_ptr<AsyncTextState> state = async;
+        std::shared_ptr<TTF_Font> jobFont = fontCache().share(font); // Keeps a cached font open until the job is done
+        TextUploadQueue* queue = &textUploadQueue(); // Made before the job can need it
+        SDL_Color jobColor = textColor;
+        sharedWorkerPool().run([state, serial, jobFont, queue, jobColor, newText]() mutable
+        {
+            SDL_Surface* surface = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(fontMutex(jobFont.get())); // TTF_Fonts are not safe to use from two threads at once
+                surface = TTF_RenderText_Solid(jobFont.get(), newText.c_str(), jobColor);
+            }
+            {
+                // Hand the font back to the render thread, in case this was its last handle
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                queue->fonts.push_back(std::move(jobFont));
+            }
+            bool needsQueue = false;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (serial != state->requested || state->owner == nullptr) {SDL_FreeSurface(surface); return;} // Already out of date
+                SDL_FreeSurface(state->surface);
+                state->surface = surface; // nullptr for empty text, which still has to clear the old text
+                state->ready = true;
+                state->finished = serial;
+                needsQueue = !state->queued;
+                state->queued = true;
+            }
+            if (needsQueue)
+            {
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                queue->ready.push_back(state);
+            }
+        });
+    }
+    bool isPending()
+    {
+        // Whether an async update has not been swapped in yet
+        if (!async) {return false;}
+        std::lock_guard<std::mutex> lock(async->mutex);
+        return async->requested != async->finished || async->ready;
+    }
+    void render()
+    {
+        // Draws the used part of the texture at rect
+        if (texture != nullptr && source.w > 0) {SDL_RenderCopy(sdl.renderer, texture, &source, &rect);}
+    }
+    SDL_Texture* getTexture() {return texture;} // Only the source rect of it holds the text. Owned by this Text
     // Variables
-    SDL_Texture* texture = nullptr;
     SDL_Color textColor = {255, 255, 255};
     SDL_Rect rect = {0, 0, 0, 0};
+    SDL_Rect source = {0, 0, 0, 0}; // The part of texture holding the text
     TTF_Font* font = nullptr;
 private:
     // Functions
+    bool isUnchanged(const std::string& newText)
+    {
+        // Whether the texture already shows exactly this
+        return texture != nullptr && newText == text && !isPending()
+            && textColor.r == renderedColor.r && textColor.g == renderedColor.g && textColor.b == renderedColor.b && textColor.a == renderedColor.a;
+    }
+    void uploadSurface(SDL_Surface* surface)
+    {
+        // Copies a rendered surface into texture, only making a new texture when the text no longer fits
+        // Capacity doubles when it grows, so text that keeps getting longer rarely reallocates
+        if (surface == nullptr) // Empty text
+        {
+            source.w = source.h = rect.w = rect.h = 0;
+            return;
+        }
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0); // Solid text is 8-bit, textures want 32
+        if (converted == nullptr)
+        {
+            std::cout << "Unable to convert text surface! SDL Error: " << SDL_GetError() << std::endl;
+            return; // Keeps showing the old text
+        }
+        if (converted->w > capacityWidth || converted->h > capacityHeight)
+        {
+            capacityWidth = std::max(converted->w, capacityWidth * 2);
+            capacityHeight = std::max(converted->h, capacityHeight * 2);
+            SDL_DestroyTexture(texture);
+            texture = SDL_CreateTexture(sdl.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, capacityWidth, capacityHeight);
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        }
+        source = {0, 0, converted->w, converted->h};
+        SDL_UpdateTexture(texture, &source, converted->pixels, converted->pitch);
+        SDL_FreeSurface(converted);
+        rect.w = source.w;
+        rect.h = source.h;
+    }
+    void cancelAsync()
+    {
+        // Makes any async update still in flight out of date
+        if (!async) {return;}
+        std::lock_guard<std::mutex> lock(async->mutex);
+        async->finished = ++async->requested;
+        SDL_FreeSurface(async->surface);
+        async->surface = nullptr;
+        async->ready = false;
+    }
+    void takeFrom(Text& other)
+    {
+        // Moves other's texture, text and async update into this one (which must have none of its own), leaving other empty
+        texture = other.texture;
+        capacityWidth = other.capacityWidth;
+        capacityHeight = other.capacityHeight;
+        source = other.source;
+        text = std::move(other.text);
+        renderedColor = other.renderedColor;
+        async = std::move(other.async);
+        other.texture = nullptr;
+        other.capacityWidth = other.capacityHeight = 0;
+        other.source = {0, 0, 0, 0};
+        other.async.reset();
+        if (async)
+        {
+            std::lock_guard<std::mutex> lock(async->mutex); // A finished job hands its surface to whichever Text owner points at
+            async->owner = this;
+        }
+    }
+    void detach()
+    {
+        // Stops async jobs from handing textures to this Text
+        if (!async) {return;}
+        std::shared_ptr<AsyncTextState> state = async; // Keeps the mutex alive while it's locked
+        async.reset();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->owner = nullptr;
+    }
     // Variables
+    SDL_Texture* texture = nullptr; // Usually bigger than the text. See source
     std::string text = "";
+    std::shared_ptr<AsyncTextState> async; // Only made once setTextAsync() is first used
+    SDL_Color renderedColor = {255, 255, 255, 255}; // The textColor the texture was rendered with
+    int capacityWidth = 0; // The actual size of texture
+    int capacityHeight = 0;
+    friend int uploadTextSurfaces(int budget);
+};
+
+inline int uploadTextSurfaces(int budget)
+{
+    // Call once per frame on the render thread. Turns up to budget finished async Text surfaces into textures, oldest first
+    // Whatever is left over waits for next frame, so a burst of text changes never causes a hitch. Returns how many were uploaded
+    std::vector<std::shared_ptr<TTF_Font>> finishedFonts; // Let go of here at the end, on the render thread
+    {
+        std::lock_guard<std::mutex> lock(textUploadQueue().mutex);
+        finishedFonts.swap(textUploadQueue().fonts);
+    }
+    int uploaded = 0;
+    while (uploaded < budget)
+    {
+        std::shared_ptr<AsyncTextState> state;
+        {
+            std::lock_guard<std::mutex> lock(textUploadQueue().mutex);
+            if (textUploadQueue().ready.empty()) {break;}
+            state = textUploadQueue().ready.front();
+            textUploadQueue().ready.pop_front();
+        }
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->queued = false;
+        if (state->owner == nullptr || !state->ready) {continue;} // Destroyed or cancelled since, costs nothing
+        state->owner->uploadSurface(state->surface); // A null surface (empty text) clears it
+        SDL_FreeSurface(state->surface);
+        state->surface = nullptr;
+        state->ready = false;
+        uploaded++;
+    }
+    return uploaded;
+}
+
+/// /// ///
+
+struct Glyph
+{
+    // Where one glyph lives in a GlyphAtlas, and how to place it
+    SDL_Rect source = {0, 0, 0, 0}; // The glyph's pixels in the atlas texture. Width is 0 for glyphs with nothing to draw (like spaces)
+    int offsetX = 0; // Where the glyph's pixels start relative to the pen position
+    int advance = 0; // How far the pen moves after this glyph
+    bool loaded = false; // Whether this glyph has been rasterized yet
+};
+
+class GlyphAtlas
+{
+    // Every glyph of one font (at its size and style) rasterized once, in white, into a single shared texture
+    // Glyphs are added the first time they are used and packed in rows (shelves). If the atlas fills up, it doubles in height
+    // Color comes from vertex colors when drawing, so one atlas serves every text color
+public:
+    // Functions
+    GlyphAtlas(TTF_Font* baseFont, int fontStyle, int atlasWidth = 512)
+    {
+        font = baseFont;
+        style = fontStyle;
+        fontLock = &fontMutex(font);
+        {
+            std::lock_guard<std::mutex> lock(*fontLock); // An async Text update could be using the font
+            lineHeight = TTF_FontHeight(font);
+        }
+        surface = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, std::max(64, lineHeight * 4), 32, SDL_PIXELFORMAT_ARGB8888);
+        upload();
+    }
+    ~GlyphAtlas()
+    {
+        SDL_DestroyTexture(texture);
+        SDL_FreeSurface(surface);
+    }
+    GlyphAtlas(const GlyphAtlas&) = delete; // Owns its texture
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+    const Glyph& getGlyph(unsigned char character)
+    {
+        // Returns the glyph, rasterizing it into the atlas the first time it's asked for
+        Glyph& glyph = glyphs[character];
+        if (glyph.loaded) {return glyph;}
+        glyph.loaded = true;
+        if (character == 0) {return glyph;}
+
+        int minX = 0;
+        SDL_Surface* glyphSurface = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(*fontLock); // An async Text update could be using the font
+            TTF_GlyphMetrics(font, character, &minX, nullptr, nullptr, nullptr, &glyph.advance);
+            int originalStyle = TTF_GetFontStyle(font);
+            TTF_SetFontStyle(font, style);
+            SDL_Color white = {255, 255, 255, 255};
+            glyphSurface = TTF_RenderGlyph_Blended(font, character, white);
+            TTF_SetFontStyle(font, originalStyle);
+        }
+        glyph.offsetX = std::min(0, minX); // Rendered glyphs start at the pen, or earlier if they hang left of it
+        if (glyphSurface == nullptr) {return glyph;} // Nothing to draw (or the font doesn't have it). Still advances the pen
+
+        // Find room on a shelf, starting a new shelf (or growing the atlas) when this one is full
+        if (shelfX + glyphSurface->w + 1 > surface->w)
+        {
+            shelfX = 0;
+            shelfY += shelfHeight + 1;
+            shelfHeight = 0;
+        }
+        while (shelfY + glyphSurface->h > surface->h) {grow();}
+        glyph.source = {shelfX, shelfY, glyphSurface->w, glyphSurface->h};
+        shelfX += glyphSurface->w + 1; // 1 pixel gap so linear filtering never bleeds between glyphs
+        shelfHeight = std::max(shelfHeight, glyphSurface->h);
+
+        // Copy the exact pixels (no blending) and upload just this glyph
+        SDL_SetSurfaceBlendMode(glyphSurface, SDL_BLENDMODE_NONE);
+        SDL_Rect destination = glyph.source;
+        SDL_BlitSurface(glyphSurface, nullptr, surface, &destination);
+        SDL_FreeSurface(glyphSurface);
+        SDL_UpdateTexture(texture, &glyph.source, (Uint8*)surface->pixels + glyph.source.y * surface->pitch + glyph.source.x * 4, surface->pitch);
+        return glyph;
+    }
+    int kerning(unsigned char previous, unsigned char character)
+    {
+        // Returns the extra pen movement between two glyphs. 0 if either is missing
+        // Asks SDL_ttf once per pair, so the font is only locked the first time a pair is seen
+        if (previous == 0 || character == 0) {return 0;}
+        if (kerningPairs.empty()) {kerningPairs.assign(256 * 256, short(UNKNOWN_KERNING));}
+        short& kern = kerningPairs[previous * 256 + character];
+        if (kern == UNKNOWN_KERNING)
+        {
+            std::lock_guard<std::mutex> lock(*fontLock);
+            int originalStyle = TTF_GetFontStyle(font);
+            TTF_SetFontStyle(font, style);
+            kern = TTF_GetFontKerningSizeGlyphs(font, previous, character);
+            TTF_SetFontStyle(font, originalStyle);
+        }
+        return kern;
+    }
+    int layout(const std::string& line, SDL_Color color, float x, float y, std::vector<SDL_Vertex>& vertices, std::vector<int>& indices)
+    {
+        // Appends one textured quad per visible glyph of the line, with the pen starting at (x, y) (top left of the line)
+        // Returns the width of the line in pixels. Does not clear vertices or indices, so many lines can share one array
+        // Make sure every glyph is in the atlas first, since adding one can grow the atlas and move every texture coordinate
+        for (char c : line) {getGlyph(c);}
+
+        float invWidth = 1.0f / surface->w;
+        float invHeight = 1.0f / surface->h;
+        float penX = x;
+        float right = x;
+        unsigned char previous = 0;
+        for (char c : line)
+        {
+            unsigned char character = c;
+            const Glyph& glyph = glyphs[character];
+            penX += kerning(previous, character);
+            if (glyph.source.w > 0)
+            {
+                float left = penX + glyph.offsetX;
+                float top = y;
+                float u0 = glyph.source.x * invWidth;
+                float v0 = glyph.source.y * invHeight;
+                float u1 = (glyph.source.x + glyph.source.w) * invWidth;
+                float v1 = (glyph.source.y + glyph.source.h) * invHeight;
+                int first = vertices.size();
+                vertices.push_back({{left, top}, color, {u0, v0}});
+                vertices.push_back({{left + glyph.source.w, top}, color, {u1, v0}});
+                vertices.push_back({{left + glyph.source.w, top + glyph.source.h}, color, {u1, v1}});
+                vertices.push_back({{left, top + glyph.source.h}, color, {u0, v1}});
+                indices.insert(indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+                right = std::max(right, left + glyph.source.w);
+            }
+            penX += glyph.advance;
+            previous = character;
+        }
+        return (int)(std::max(right, penX) - x + 0.5f);
+    }
+    // Variables
+    TTF_Font* font = nullptr; // The font this atlas was made from
+    int style = TTF_STYLE_NORMAL; // The TTF style glyphs are rasterized with
+    int lineHeight = 0; // TTF_FontHeight of the font
+    SDL_Texture* texture = nullptr; // The atlas itself. Draw with SDL_RenderGeometry
+    int generation = 0; // Goes up whenever the atlas grows (all texture coordinates change), so users know to lay out again
+    int getWidth() {return surface->w;} // Size of the atlas texture, for turning glyph sources into texture coordinates
+    int getHeight() {return surface->h;}
+private:
+    // Functions
+    void upload()
+    {
+        // Remakes the texture from the CPU copy of the atlas
+        SDL_DestroyTexture(texture);
+        texture = SDL_CreateTexture(sdl.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, surface->w, surface->h);
+        SDL_UpdateTexture(texture, nullptr, surface->pixels, surface->pitch);
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+    void grow()
+    {
+        // Doubles the height of the atlas, keeping every glyph where it was
+        SDL_Surface* bigger = SDL_CreateRGBSurfaceWithFormat(0, surface->w, surface->h * 2, 32, SDL_PIXELFORMAT_ARGB8888);
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(surface, nullptr, bigger, nullptr);
+        SDL_FreeSurface(surface);
+        surface = bigger;
+        upload();
+        generation++;
+    }
+    // Variables
+    static const short UNKNOWN_KERNING = -32768;
+    std::mutex* fontLock = nullptr; // fontMutex(font), looked up once
+    SDL_Surface* surface = nullptr; // CPU copy of the atlas, so it can grow without render target copies
+    std::vector<short> kerningPairs; // 256 x 256, indexed [previous * 256 + character]. UNKNOWN_KERNING until asked for. Only made once kerning is needed
+    Glyph glyphs[256]; // Text is 8-bit (TTF_RenderText), so every possible glyph fits in a flat table
+    int shelfX = 0; // Where the next glyph goes on the current shelf
+    int shelfY = 0; // Top of the current shelf
+    int shelfHeight = 0; // Height of the tallest glyph on the current shelf
+};
+
+inline std::map<std::pair<TTF_Font*, int>, GlyphAtlas*>& glyphAtlases()
+{
+    // Every atlas made so far, keyed by font (which includes its size) and style. Only used on the render thread, or by a font closing at exit
+    // Never destroyed, for that font
+    static std::map<std::pair<TTF_Font*, int>, GlyphAtlas*>* atlases = new std::map<std::pair<TTF_Font*, int>, GlyphAtlas*>();
+    return *atlases;
+}
+
+inline GlyphAtlas* getGlyphAtlas(TTF_Font* font)
+{
+    // Returns the shared atlas for the font at its current style, making it the first time
+    int style = 0;
+    {
+        std::lock_guard<std::mutex> lock(fontMutex(font));
+        style = TTF_GetFontStyle(font);
+    }
+    std::pair<TTF_Font*, int> key(font, style);
+    std::map<std::pair<TTF_Font*, int>, GlyphAtlas*>& atlases = glyphAtlases();
+    std::map<std::pair<TTF_Font*, int>, GlyphAtlas*>::iterator found = atlases.find(key);
+    if (found != atlases.end()) {return found->second;}
+    GlyphAtlas* atlas = new GlyphAtlas(font, key.second);
+    atlases[key] = atlas;
+    return atlas;
+}
+
+inline void releaseGlyphAtlases(TTF_Font* font)
+{
+    // Destroys every atlas made from this font. Must be called before the font is closed
+    std::map<std::pair<TTF_Font*, int>, GlyphAtlas*>& atlases = glyphAtlases();
+    for (std::map<std::pair<TTF_Font*, int>, GlyphAtlas*>::iterator it = atlases.begin(); it != atlases.end(); )
+    {
+        if (it->first.first == font)
+        {
+            delete it->second;
+            it = atlases.erase(it);
+        }
+        else {++it;}
+    }
+}
+
+class AtlasText
+{
+    // Like Text, but draws quads out of the font's shared GlyphAtlas instead of owning a texture
+    // Changing the text only rebuilds a vertex array, so text that changes often (timers, scores, chat) is nearly free
+    // FEATURES: only updates when text changes, kerning-aware. rect.w and rect.h are the text size; it is drawn at rect.x, rect.y without scaling
+public:
+    // Functions
+    AtlasText(TTF_Font* baseFont, const std::string& initialText)
+    {
+        font = baseFont;
+        atlas = getGlyphAtlas(font);
+        text = initialText;
+        layout();
+    }
+    std::string& getText() {return text;} // So that we can't change it without updating
+    void setText(const std::string& newText)
+    {
+        if (newText == text) {return;}
+        text = newText;
+        layout();
+    }
+    void setColor(SDL_Color newColor)
+    {
+        // Recolors in place, no layout needed
+        textColor = newColor;
+        for (SDL_Vertex& vertex : vertices) {vertex.color = textColor;}
+    }
+    void render()
+    {
+        // Draws the whole text in one geometry call
+        if (atlas->generation != layoutGeneration) {layout();} // The atlas grew since the last layout
+        if (rect.x != layoutX || rect.y != layoutY)
+        {
+            // Moved: shift the existing quads instead of laying out again
+            for (SDL_Vertex& vertex : vertices)
+            {
+                vertex.position.x += rect.x - layoutX;
+                vertex.position.y += rect.y - layoutY;
+            }
+            layoutX = rect.x;
+            layoutY = rect.y;
+        }
+        if (!indices.empty())
+        {
+            SDL_RenderGeometry(sdl.renderer, atlas->texture, vertices.data(), vertices.size(), indices.data(), indices.size());
+        }
+    }
+    // Variables
+    SDL_Color textColor = {255, 255, 255, 255};
+    SDL_Rect rect = {0, 0, 0, 0};
+    TTF_Font* font = nullptr;
+private:
+    // Functions
+    void layout()
+    {
+        // Rebuilds the quads. The vectors keep their capacity, so this stops allocating once the text has been its longest
+        vertices.clear();
+        indices.clear();
+        rect.w = atlas->layout(text, textColor, rect.x, rect.y, vertices, indices);
+        rect.h = atlas->lineHeight;
+        layoutX = rect.x;
+        layoutY = rect.y;
+        layoutGeneration = atlas->generation;
+    }
+    // Variables
+    std::string text = "";
+    GlyphAtlas* atlas = nullptr; // Shared with every other AtlasText of the same font and style
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    int layoutX = 0; // Where the quads were laid out
+    int layoutY = 0;
+    int layoutGeneration = 0; // The atlas generation the quads were laid out with
+};
+
+/// /// ///
+
+class LabelManager
+{
+    // Packs many rendered strings (labels) into a few shared atlas pages, so 200 menu labels are a handful of draws instead of 200 textures
+    // Labels are rendered once in white and tinted with vertex colors, and every visible label on a page is drawn with one SDL_RenderGeometry call
+    // Each page is packed in rows (shelves). Removing labels leaves holes, which are squeezed out by defragment() (done automatically once half the packed space is holes)
+public:
+    // Functions
+    LabelManager(int pageWidth = 1024, int pageHeight = 1024)
+    {
+        defaultPageWidth = pageWidth;
+        defaultPageHeight = pageHeight;
+    }
+    ~LabelManager()
+    {
+        for (Page& page : pages) {freePage(page);}
+    }
+    LabelManager(const LabelManager&) = delete; // Owns its pages
+    LabelManager& operator=(const LabelManager&) = delete;
+    int add(TTF_Font* font, const std::string& text, int x = 0, int y = 0, SDL_Color color = {255, 255, 255, 255})
+    {
+        // Makes a new label and returns its id (ids stay valid until removed)
+        int id;
+        if (!freeIds.empty())
+        {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else
+        {
+            id = labels.size();
+            labels.push_back(Label());
+        }
+        Label& label = labels[id];
+        label = Label();
+        label.alive = true;
+        label.font = font;
+        label.color = color;
+        label.rect.x = x;
+        label.rect.y = y;
+        setText(id, text);
+        return id;
+    }
+    void setText(int id, const std::string& text)
+    {
+        // Re-renders a label. Reuses its spot in the page when the new text still fits
+        Label& label = labels[id];
+        if (label.page != -1 && text == label.text) {return;}
+        label.text = text;
+        SDL_Surface* rendered = nullptr;
+        if (!text.empty())
+        {
+            std::lock_guard<std::mutex> lock(fontMutex(label.font));
+            rendered = TTF_RenderText_Blended(label.font, text.c_str(), {255, 255, 255, 255});
+        }
+        int width = rendered ? rendered->w : 0;
+        int height = rendered ? rendered->h : 0;
+
+        if (label.page == -1 || width > label.slot.w || height > label.slot.h)
+        {
+            release(label);
+            if (rendered != nullptr) {place(label, width, height);}
+        }
+        label.source = {label.slot.x, label.slot.y, width, height};
+        label.rect.w = width;
+        label.rect.h = height;
+        if (rendered != nullptr)
+        {
+            // Clear the whole slot (the old text may have been bigger), then copy the exact pixels in and upload just the slot
+            Page& page = pages[label.page];
+            SDL_FillRect(page.surface, &label.slot, 0);
+            SDL_SetSurfaceBlendMode(rendered, SDL_BLENDMODE_NONE);
+            SDL_Rect destination = label.source;
+            SDL_BlitSurface(rendered, nullptr, page.surface, &destination);
+            SDL_FreeSurface(rendered);
+            SDL_UpdateTexture(page.texture, &label.slot, (Uint8*)page.surface->pixels + label.slot.y * page.surface->pitch + label.slot.x * 4, page.surface->pitch);
+        }
+    }
+    void remove(int id)
+    {
+        // Frees a label's id and its space in the page. Removing one that's already gone does nothing, so its id can't be handed out twice
+        if (id < 0 || id >= (int)labels.size() || !labels[id].alive) {return;}
+        release(labels[id]);
+        labels[id].alive = false;
+        freeIds.push_back(id);
+        if (freedArea * 2 > packedArea) {defragment();}
+    }
+    SDL_Rect& rect(int id) {return labels[id].rect;} // Where the label is drawn. Change x and y to move it (w and h scale it)
+    void setColor(int id, SDL_Color color) {labels[id].color = color;} // Free, labels are tinted when drawn
+    void setVisible(int id, bool visible) {labels[id].visible = visible;}
+    void render()
+    {
+        // Draws every visible label, one geometry call per page
+        for (Page& page : pages)
+        {
+            page.vertices.clear(); // Keeps capacity, so no allocations once the menu has been drawn once
+            page.indices.clear();
+        }
+        for (const Label& label : labels)
+        {
+            if (!label.alive || !label.visible || label.page == -1 || label.source.w == 0) {continue;}
+            Page& page = pages[label.page];
+            float invWidth = 1.0f / page.surface->w;
+            float invHeight = 1.0f / page.surface->h;
+            float u0 = label.source.x * invWidth;
+            float v0 = label.source.y * invHeight;
+            float u1 = (label.source.x + label.source.w) * invWidth;
+            float v1 = (label.source.y + label.source.h) * invHeight;
+            float left = label.rect.x;
+            float top = label.rect.y;
+            float right = label.rect.x + label.rect.w;
+            float bottom = label.rect.y + label.rect.h;
+            int first = page.vertices.size();
+            page.vertices.push_back({{left, top}, label.color, {u0, v0}});
+            page.vertices.push_back({{right, top}, label.color, {u1, v0}});
+            page.vertices.push_back({{right, bottom}, label.color, {u1, v1}});
+            page.vertices.push_back({{left, bottom}, label.color, {u0, v1}});
+            page.indices.insert(page.indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+        }
+        for (Page& page : pages)
+        {
+            if (page.indices.empty()) {continue;}
+            SDL_RenderGeometry(sdl.renderer, page.texture, page.vertices.data(), page.vertices.size(), page.indices.data(), page.indices.size());
+        }
+    }
+    void defragment()
+    {
+        // Repacks every live label tightly into fresh pages (tallest first, which packs shelves best), copying pixels instead of re-rendering
+        std::vector<Page> oldPages;
+        oldPages.swap(pages);
+        packedArea = 0;
+        freedArea = 0;
+        std::vector<int> order;
+        for (int id = 0; id < (int)labels.size(); id++)
+        {
+            if (labels[id].alive && labels[id].page != -1) {order.push_back(id);}
+        }
+        std::sort(order.begin(), order.end(), [this](int a, int b) {return labels[a].source.h > labels[b].source.h;});
+        for (int id : order)
+        {
+            Label& label = labels[id];
+            SDL_Surface* oldSurface = oldPages[label.page].surface;
+            SDL_Rect oldSource = label.source;
+            place(label, oldSource.w, oldSource.h);
+            label.source = {label.slot.x, label.slot.y, oldSource.w, oldSource.h};
+            SDL_SetSurfaceBlendMode(oldSurface, SDL_BLENDMODE_NONE);
+            SDL_Rect destination = label.source;
+            SDL_BlitSurface(oldSurface, &oldSource, pages[label.page].surface, &destination);
+        }
+        for (Page& page : pages) {SDL_UpdateTexture(page.texture, nullptr, page.surface->pixels, page.surface->pitch);}
+        for (Page& page : oldPages) {freePage(page);}
+    }
+    int pageCount() {return pages.size();}
+private:
+    // Types
+    struct Label
+    {
+        bool alive = false;
+        bool visible = true;
+        TTF_Font* font = nullptr;
+        std::string text = "";
+        SDL_Color color = {255, 255, 255, 255};
+        int page = -1; // Which page the label is packed into, -1 if it has no pixels
+        SDL_Rect slot = {0, 0, 0, 0}; // The space reserved for it in the page
+        SDL_Rect source = {0, 0, 0, 0}; // The part of slot the text actually uses
+        SDL_Rect rect = {0, 0, 0, 0}; // Where it is drawn
+    };
+    struct Shelf
+    {
+        int y; // Top of the shelf
+        int height; // Height of the shelf
+        int x; // Where the next slot starts
+    };
+    struct Page
+    {
+        SDL_Surface* surface = nullptr; // CPU copy, so defragment() can move pixels around without render targets
+        SDL_Texture* texture = nullptr;
+        std::vector<Shelf> shelves;
+        int nextShelfY = 0; // Where the next shelf starts
+        std::vector<SDL_Vertex> vertices; // Reused by render()
+        std::vector<int> indices;
+    };
+    // Functions
+    void place(Label& label, int width, int height)
+    {
+        // Finds a slot for a label of this size: the first shelf it fits on that isn't too much taller than it, else a new shelf, else a new page
+        for (int p = 0; p < (int)pages.size(); p++)
+        {
+            Page& page = pages[p];
+            for (Shelf& shelf : page.shelves)
+            {
+                if (height <= shelf.height && height * 2 >= shelf.height && shelf.x + width <= page.surface->w)
+                {
+                    label.page = p;
+                    label.slot = {shelf.x, shelf.y, width, shelf.height};
+                    shelf.x += width + 1; // 1 pixel gap so linear filtering never bleeds between labels
+                    packedArea += width * shelf.height;
+                    return;
+                }
+            }
+            if (page.nextShelfY + height <= page.surface->h && width <= page.surface->w)
+            {
+                page.shelves.push_back({page.nextShelfY, height, width + 1});
+                page.nextShelfY += height + 1;
+                label.page = p;
+                label.slot = {0, page.shelves.back().y, width, height};
+                packedArea += width * height;
+                return;
+            }
+        }
+        // No room anywhere, start a new page (big enough for even an oversized label)
+        Page page;
+        page.surface = SDL_CreateRGBSurfaceWithFormat(0, std::max(defaultPageWidth, width), std::max(defaultPageHeight, height), 32, SDL_PIXELFORMAT_ARGB8888);
+        page.texture = SDL_CreateTexture(sdl.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, page.surface->w, page.surface->h);
+        SDL_UpdateTexture(page.texture, nullptr, page.surface->pixels, page.surface->pitch);
+        SDL_SetTextureBlendMode(page.texture, SDL_BLENDMODE_BLEND);
+        page.shelves.push_back({0, height, width + 1});
+        page.nextShelfY = height + 1;
+        pages.push_back(std::move(page));
+        label.page = pages.size() - 1;
+        label.slot = {0, 0, width, height};
+        packedArea += width * height;
+    }
+    void release(Label& label)
+    {
+        // Gives up a label's slot. The space is only reused after defragment()
+        if (label.page == -1) {return;}
+        freedArea += label.slot.w * label.slot.h;
+        label.page = -1;
+        label.slot = {0, 0, 0, 0};
+        label.source = {0, 0, 0, 0};
+    }
+    void freePage(Page& page)
+    {
+        SDL_DestroyTexture(page.texture);
+        SDL_FreeSurface(page.surface);
+        page.texture = nullptr;
+        page.surface = nullptr;
+    }
+    // Variables
+    std::vector<Label> labels;
+    std::vector<int> freeIds; // Ids of removed labels, reused by add()
+    std::vector<Page> pages;
+    int defaultPageWidth;
+    int defaultPageHeight;
+    int packedArea = 0; // Total area of every slot handed out since the last defragment
+    int freedArea = 0; // How much of that has been released since
+};
+
+/// /// ///
+
+class NumberText
+{
+    // A fast path for numbers that change every frame (scores, FPS readouts, timers)
+    // The digit strip (0-9, '-', '.') comes from the font's shared GlyphAtlas, with advances and kerning looked up once in the constructor,
+    // so setting a value just fills fixed arrays of quads: no string formatting, no allocation, no rasterizing
+public:
+    // Functions
+    NumberText(TTF_Font* baseFont)
+    {
+        font = baseFont;
+        atlas = getGlyphAtlas(font);
+        for (int i = 0; i < NumberStrip::SIZE; i++)
+        {
+            atlas->getGlyph(NumberStrip::character(i));
+            for (int j = 0; j < NumberStrip::SIZE; j++) {kerning[i][j] = atlas->kerning(NumberStrip::character(i), NumberStrip::character(j));}
+        }
+        rect.h = atlas->lineHeight;
+        setInt(0);
+    }
+    void setInt(long long value) {setFixed(value, 0);}
+    void setFloat(double value, int decimals) {setFixed(NumberStrip::roundFixed(value, decimals), decimals);} // Rounds to the given number of decimals, then shows it like setFixed
+    void setFixed(long long value, int decimals)
+    {
+        // Shows a fixed-point value: setFixed(12345, 2) shows "123.45"
+        if (value == currentValue && decimals == currentDecimals) {return;}
+        currentValue = value;
+        currentDecimals = decimals;
+        number.setFixed(value, decimals);
+        const int* strip = number.strip;
+        rect.w = 0;
+        for (int i = 0; i < number.length; i++)
+        {
+            if (i > 0) {rect.w += kerning[strip[i - 1]][strip[i]];}
+            rect.w += atlas->getGlyph(NumberStrip::character(strip[i])).advance;
+        }
+        dirty = true;
+    }
+    void setColor(SDL_Color newColor)
+    {
+        // Recolors in place, no layout needed, so it shows on the next render() like SDL_Text::NumberDisplay
+        textColor = newColor;
+        for (int i = 0; i < quads * 4; i++) {number.vertices[i].color = textColor;}
+    }
+    void render()
+    {
+        // Draws the number at rect.x, rect.y in one geometry call
+        if (dirty || rect.x != layoutX || rect.y != layoutY || atlas->generation != layoutGeneration) {layout();}
+        if (quads > 0) {SDL_RenderGeometry(sdl.renderer, atlas->texture, number.vertices, quads * 4, number.indices, quads * 6);}
+    }
+    // Variables
+    SDL_Color textColor = {255, 255, 255, 255}; // Change with setColor(). Set directly, it only takes effect on the next value change (or move)
+    SDL_Rect rect = {0, 0, 0, 0}; // Drawn at x, y without scaling. w and h are the size of the current number
+    TTF_Font* font = nullptr;
+private:
+    // Functions
+    void layout()
+    {
+        // Fills the quads for the current characters
+        float invWidth = 1.0f / atlas->getWidth();
+        float invHeight = 1.0f / atlas->getHeight();
+        float penX = rect.x;
+        const int* strip = number.strip;
+        quads = 0;
+        for (int i = 0; i < number.length; i++)
+        {
+            const Glyph& glyph = atlas->getGlyph(NumberStrip::character(strip[i]));
+            if (i > 0) {penX += kerning[strip[i - 1]][strip[i]];}
+            if (glyph.source.w > 0)
+            {
+                float left = penX + glyph.offsetX;
+                float top = rect.y;
+                float u0 = glyph.source.x * invWidth;
+                float v0 = glyph.source.y * invHeight;
+                float u1 = (glyph.source.x + glyph.source.w) * invWidth;
+                float v1 = (glyph.source.y + glyph.source.h) * invHeight;
+                number.setQuad(quads, left, top, left + glyph.source.w, top + glyph.source.h, u0, v0, u1, v1, textColor);
+                quads++;
+            }
+            penX += glyph.advance;
+        }
+        layoutX = rect.x;
+        layoutY = rect.y;
+        layoutGeneration = atlas->generation;
+        dirty = false;
+    }
+    // Variables
+    GlyphAtlas* atlas = nullptr; // Shared with everything else drawn in this font
+    NumberStrip number; // The current number and its quads
+    int kerning[NumberStrip::SIZE][NumberStrip::SIZE]; // Kerning between every pair of strip characters
+    int quads = 0; // How many quads of vertices are in use
+    long long currentValue = -1; // What is currently shown (starts as something setInt(0) will replace)
+    int currentDecimals = -1;
+    bool dirty = true; // Whether the quads need filling again
+    int layoutX = 0; // Where the quads were filled
+    int layoutY = 0;
+    int layoutGeneration = 0;
 };
\ No newline at end of file
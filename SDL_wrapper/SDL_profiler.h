@@ -0,0 +1,218 @@
+#ifndef SDL_PROFILER_H_INCLUDED
+#define SDL_PROFILER_H_INCLUDED
+
+#include <string>
+#include <iostream> // For errors
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm> // For std::min
+
+/*
+A small scoped profiler for finding where a frame's time goes. Writes Chrome trace JSON (open it in chrome://tracing or ui.perfetto.dev)
+
+Usage:
+    Build with SDL_PROFILER defined (-DSDL_PROFILER) to compile the zones in. Without it, every SDL_PROFILE_ZONE() is removed entirely
+    Put SDL_PROFILE_ZONE("name"); at the top of any block to time it. Names must be string literals (only the pointer is kept)
+    sharedProfiler().start(); ... frames ... sharedProfiler().stop(); sharedProfiler().writeTrace("trace.json");
+    The wrappers already time SDL::clear/update/FPSwait, the SDL_Text writers, the CRT filters, Animatic and AnimaticWrapper updates, and WorkerPool jobs
+
+Each thread records into its own fixed buffer that only it writes, so a zone costs two clock reads and a store, with no locks
+A zone only takes a lock the first time its thread records anything (to register the buffer)
+When a thread's buffer is full, further zones are counted in dropped() instead of recorded
+*/
+
+#define SDL_PROFILE_CONCAT_INNER(a, b) a##b
+#define SDL_PROFILE_CONCAT(a, b) SDL_PROFILE_CONCAT_INNER(a, b)
+#ifdef SDL_PROFILER
+    #define SDL_PROFILE_ZONE(name) ProfileZone SDL_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+    #define SDL_PROFILE_ZONE(name)
+#endif
+
+class Profiler
+{
+    // Collects timed zones from every thread. Use sharedProfiler() rather than making one
+public:
+    // Functions
+    inline Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    inline void start(); // Forgets anything recorded before and starts recording. Call between frames, while no zones are open
+    inline void stop(); // Stops recording. Zones already open still finish
+    inline bool isRecording() {return recording.load(std::memory_order_relaxed);}
+    inline void nameThread(std::string name); // Labels the calling thread in the trace ("main", "loader", etc.)
+    inline void record(const char* name, long long start, long long end); // Adds a finished zone for the calling thread. ProfileZone calls this
+    inline long long now(); // Nanoseconds since the profiler was made
+    inline long long dropped(); // How many zones didn't fit in their thread's buffer since start()
+    inline bool writeTrace(std::string filepath); // Writes everything recorded as Chrome trace JSON. Returns if written. Best done after stop()
+    // Variables
+    static const int EVENTS_PER_THREAD = 1 << 16; // Per thread, per recording
+private:
+    // Types
+    struct Event {
+        const char* name;
+        long long start; // Nanoseconds since the profiler was made
+        long long duration;
+    };
+    struct ThreadBuffer {
+        int id;
+        std::string name;
+        std::vector<Event> events; // Sized once, only ever written by its own thread
+        std::atomic<int> count{0}; // Events written. Stored after the event, so a reader never sees a half-written one
+        std::atomic<long long> dropped{0};
+    };
+    // Functions
+    inline ThreadBuffer* threadBuffer(); // The calling thread's buffer, made the first time it's needed
+    // Variables
+    std::atomic<bool> recording{false};
+    std::chrono::steady_clock::time_point epoch;
+    std::mutex buffersMutex; // Only for adding a thread's buffer, and for reading them all
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers; // Kept after their threads end, so nothing recorded is lost
+};
+
+inline Profiler& sharedProfiler()
+{
+    // The process-wide profiler every zone records into, made on first use
+    static Profiler profiler;
+    return profiler;
+}
+
+class ProfileZone
+{
+    // Times the scope it lives in. Use SDL_PROFILE_ZONE("name") so it compiles out without SDL_PROFILER
+public:
+    inline ProfileZone(const char* Name) : name(Name), start(sharedProfiler().isRecording() ? sharedProfiler().now() : -1) {}
+    inline ~ProfileZone() {if (start >= 0) {sharedProfiler().record(name, start, sharedProfiler().now());}}
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+private:
+    const char* name;
+    long long start; // -1 if the profiler wasn't recording when the zone opened
+};
+
+Profiler::Profiler()
+{
+    epoch = std::chrono::steady_clock::now();
+}
+
+void Profiler::start()
+{
+    // Forgets anything recorded before and starts recording
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (std::unique_ptr<ThreadBuffer>& buffer : buffers)
+        {
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+    recording.store(true, std::memory_order_release);
+}
+
+void Profiler::stop()
+{
+    recording.store(false, std::memory_order_release);
+}
+
+void Profiler::nameThread(std::string name)
+{
+    // Labels the calling thread in the trace
+    ThreadBuffer* buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer->name = name;
+}
+
+void Profiler::record(const char* name, long long start, long long end)
+{
+    // Adds a finished zone for the calling thread. Only this thread writes its buffer, so this is just a store
+    ThreadBuffer* buffer = threadBuffer();
+    int count = buffer->count.load(std::memory_order_relaxed);
+    if (count >= (int)buffer->events.size())
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[count] = {name, start, end - start};
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+long long Profiler::now()
+{
+    // Nanoseconds since the profiler was made
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+long long Profiler::dropped()
+{
+    // How many zones didn't fit in their thread's buffer since start()
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    long long total = 0;
+    for (std::unique_ptr<ThreadBuffer>& buffer : buffers) {total += buffer->dropped.load(std::memory_order_relaxed);}
+    return total;
+}
+
+bool Profiler::writeTrace(std::string filepath)
+{
+    // Writes everything recorded as Chrome trace JSON: one complete ("X") event per zone, in microseconds, plus the thread names
+    std::ofstream file(filepath);
+    if (!file)
+    {
+        std::cout << "Unable to open " << filepath << " to write the profile trace!" << std::endl;
+        return false;
+    }
+    auto writeString = [&file](const std::string& text)
+    {
+        file << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\') {file << '\\';}
+            file << c;
+        }
+        file << '"';
+    };
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    for (std::unique_ptr<ThreadBuffer>& buffer : buffers)
+    {
+        file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id << ", \"args\": {\"name\": ";
+        writeString(buffer->name.empty() ? "Thread " + std::to_string(buffer->id) : buffer->name);
+        file << "}}";
+        first = false;
+        int count = buffer->count.load(std::memory_order_acquire);
+        for (int i = 0; i < count; i++)
+        {
+            const Event& event = buffer->events[i];
+            file << ",\n{\"name\": ";
+            writeString(event.name);
+            file << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->id << ", \"ts\": " << event.start / 1000.0 << ", \"dur\": " << event.duration / 1000.0 << "}";
+        }
+    }
+    file << "\n]}\n";
+    return (bool)file;
+}
+
+Profiler::ThreadBuffer* Profiler::threadBuffer()
+{
+    // The calling thread's buffer, made the first time it's needed
+    thread_local ThreadBuffer* buffer = nullptr;
+    thread_local Profiler* owner = nullptr;
+    if (buffer != nullptr && owner == this) {return buffer;}
+    std::unique_ptr<ThreadBuffer> made(new ThreadBuffer());
+    made->events.resize(EVENTS_PER_THREAD);
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    made->id = buffers.size();
+    buffer = made.get();
+    owner = this;
+    buffers.push_back(std::move(made));
+    return buffer;
+}
+
+#endif // SDL_PROFILER_H_INCLUDED
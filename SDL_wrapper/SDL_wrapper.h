@@ -9,9 +9,55 @@
 #include <iostream> // For errors and things
 #include <math.h> // Only really used in the ellipse function
 #include <chrono> // For high-precision clocks
+#include <thread> // For the worker pool
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <deque>
+#include <list> // For the texture cache's use order
+#include <unordered_map>
+#include <vector>
+#include <stdlib.h> // For realpath/_fullpath
+#include <algorithm> // For std::min and std::max
+#include <fstream> // For FrameStats dumps
+#include "SDL_profiler.h" // For timing zones (compiled out unless SDL_PROFILER is defined)
 
 /*
 Changelog:
+    -1.11-
+        Added loadSharedTexture(std::string filepath), a cached loadTexture(): each file is decoded and uploaded once, and every load of it gets a refcounted handle to the same texture
+            Keyed by canonical path and SDL_HINT_RENDER_SCALE_QUALITY, so the same file loaded with a different scale quality is a separate texture
+            Textures stay cached after their last handle goes. textureCache.purge() unloads those, and textureCache.setBudget(bytes) unloads them least recently used first whenever the cache is over budget
+            loadTexture() is unchanged: it still returns a new texture the caller owns
+        WorkerPool::parallelFor() takes any callable and no longer allocates: helpers pick the call up from the pool directly instead of through queued std::function jobs
+        Added canonicalPath(std::string filepath), the absolute path with "." and ".." resolved. The texture and font caches key on it
+        Added the NumberStrip class, the shared core of the number fast paths (SDL_Text::NumberDisplay, NumberText): a number as indices into "0123456789-." plus fixed arrays of quads to draw it with
+    -1.10-
+        Added SDL_profiler.h (included here): scoped timing zones that record into per-thread buffers and write Chrome trace JSON
+            SDL_PROFILE_ZONE("name") - times the enclosing scope. Compiled out entirely unless SDL_PROFILER is defined
+            sharedProfiler() - start(), stop(), nameThread(name), writeTrace(filepath)
+        clear(), update(), FPSwait(), and every WorkerPool job are timed
+    -1.9-
+        Added the FrameStats class, a recorder of recent frame times: a fixed ring of the last N frames plus a log-bucketed histogram of the same frames
+            snapshot() - rolling mean, p50, p95, p99 and max, and how many recent (and total) frames were hitches
+            writeCSV(std::string filepath, std::string label) - appends one summary row per call, for comparing builds or runs
+            writeJSON(std::string filepath, std::string label) - writes the summary, the histogram and the raw frame times
+        SDL now has a frameStats member that FPSlog() and FPSdelta() record every frame into
+    -1.8-
+        FPSlog() no longer pins a core while it waits: it sleeps in 1ms naps while there's clearly time left, and only spins for the last fraction of a millisecond
+            How long a nap really takes is measured by FPSinit() and then as it goes, so pacing stays as accurate as the old busy-wait on any OS timer
+            It stops napping while a nap could still overshoot: more than its mean plus 3 standard deviations, and more than any recent long nap, is left
+            Set sleepWhileWaiting to false for the old pure spin
+        Added FPSwait() - waits until msPerFrame has passed since the last FPSlog(), without logging anything
+    -1.7-
+        Added int formatNumber(long long value, int decimals, char* buffer) - writes a (fixed-point) number as text with no allocation or printf, for counters that change every frame
+    -1.6-
+        Added the WorkerPool class, a small set of worker threads for splitting up CPU-heavy work. Jobs must never touch the renderer
+            run(std::function<void()> job) - Queues a job for any worker
+            parallelFor(int count, const Job& job) - Runs job(0) to job(count - 1) across the workers and the calling thread, returning when all are done
+        Added WorkerPool& sharedWorkerPool() - the process-wide pool the other utilities share, made on first use
     -1.5-
         Added newAntialiasedTexture(int width, int height) that will allocate and return a blank texture with antialiasing enabled
     -1.4-
@@ -60,6 +106,376 @@ Changelog:
                 FPSlog(); - Halts the game until the given framerate has been reached. After initializing using FPSinit(), call FPSlog() every game cycle to smooth framerate.
 */
 
+class FrameStats
+{
+    // Keeps the last capacity frame times in a ring, and a histogram of those same frames in log-sized buckets (16 per doubling, so about 4% wide)
+    // Recording is O(1) with no allocation. Percentiles come from the histogram, so they're accurate to within a bucket
+    // A hitch is a frame longer than hitchMs, or if that's 0, longer than hitchFactor times the recent median
+public:
+    // Types
+    struct Snapshot {
+        int frames = 0; // How many frames the numbers cover (up to capacity)
+        double mean = 0.0; // All in milliseconds
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+        int hitches = 0; // Among those frames
+        long long totalFrames = 0; // Since the last reset()
+        long long totalHitches = 0;
+    };
+    // Functions
+    inline FrameStats(int capacity = 1024); // Remembers the last capacity frames
+    inline void record(double milliseconds); // Adds a frame time
+    inline void reset(); // Forgets every frame
+    inline int count() {return frames;} // How many frames are remembered
+    inline double mean(); // Of the remembered frames, in milliseconds
+    inline double percentile(double percent); // The frame time percent% of remembered frames are at or under
+    inline double max(); // The longest remembered frame
+    inline int hitches() {return recentHitches;} // How many remembered frames were hitches
+    inline Snapshot snapshot(); // Everything above at once
+    inline bool writeCSV(std::string filepath, std::string label = ""); // Appends a summary row (and a header if the file is new). Returns if written
+    inline bool writeJSON(std::string filepath, std::string label = ""); // Writes the summary, the non-empty histogram buckets, and the remembered frames oldest first
+    // Variables
+    double hitchMs = 0.0; // Frames longer than this are hitches. 0 means use hitchFactor
+    double hitchFactor = 2.0; // Without hitchMs, frames longer than this many times the median are hitches
+    static const int BUCKETS = 16 * 17; // From 0.1ms up past 10 seconds
+private:
+    // Types
+    struct Frame {
+        float milliseconds;
+        bool hitch;
+    };
+    // Functions
+    inline int bucketAt(double percent); // The histogram bucket percent% of remembered frames are in or under
+    inline static int bucketOf(double milliseconds); // Which histogram bucket a time goes in
+    inline static double bucketMiddle(int bucket); // The time in the (geometric) middle of a bucket
+    // Variables
+    std::vector<Frame> ring;
+    int next = 0; // Where the next frame goes
+    int frames = 0;
+    double sum = 0.0; // Of the remembered frames. Recounted each time the ring wraps so rounding can't build up
+    int recentHitches = 0;
+    long long totalFrames = 0;
+    long long totalHitches = 0;
+    int histogram[BUCKETS];
+};
+
+FrameStats::FrameStats(int capacity)
+{
+    ring.resize(std::max(1, capacity));
+    reset();
+}
+
+void FrameStats::record(double milliseconds)
+{
+    // Adds a frame time, pushing out the oldest one once the ring is full
+    double limit = (hitchMs > 0.0) ? hitchMs : hitchFactor * bucketMiddle(bucketAt(50.0));
+    Frame frame = {(float)milliseconds, frames > 0 && milliseconds > limit};
+    if (frames == (int)ring.size())
+    {
+        const Frame& oldest = ring[next];
+        sum -= oldest.milliseconds;
+        histogram[bucketOf(oldest.milliseconds)]--;
+        if (oldest.hitch) {recentHitches--;}
+    }
+    else {frames++;}
+    ring[next] = frame;
+    sum += frame.milliseconds;
+    histogram[bucketOf(frame.milliseconds)]++;
+    if (frame.hitch)
+    {
+        recentHitches++;
+        totalHitches++;
+    }
+    totalFrames++;
+    next = (next + 1) % ring.size();
+    if (next == 0)
+    {
+        sum = 0.0;
+        for (const Frame& remembered : ring) {sum += remembered.milliseconds;}
+    }
+}
+
+void FrameStats::reset()
+{
+    // Forgets every frame
+    next = 0;
+    frames = 0;
+    sum = 0.0;
+    recentHitches = 0;
+    totalFrames = 0;
+    totalHitches = 0;
+    std::fill(histogram, histogram + BUCKETS, 0);
+}
+
+double FrameStats::mean()
+{
+    // Of the remembered frames, in milliseconds
+    return (frames > 0) ? sum / frames : 0.0;
+}
+
+double FrameStats::percentile(double percent)
+{
+    // The frame time percent% of remembered frames are at or under, to within a bucket (and never more than the longest frame)
+    if (frames == 0) {return 0.0;}
+    return std::min(bucketMiddle(bucketAt(percent)), max());
+}
+
+double FrameStats::max()
+{
+    // The longest remembered frame
+    float longest = 0.0;
+    for (int i = 0; i < frames; i++) {longest = std::max(longest, ring[i].milliseconds);}
+    return longest;
+}
+
+FrameStats::Snapshot FrameStats::snapshot()
+{
+    // Everything at once
+    Snapshot result;
+    result.frames = frames;
+    result.mean = mean();
+    result.p50 = percentile(50.0);
+    result.p95 = percentile(95.0);
+    result.p99 = percentile(99.0);
+    result.max = max();
+    result.hitches = recentHitches;
+    result.totalFrames = totalFrames;
+    result.totalHitches = totalHitches;
+    return result;
+}
+
+bool FrameStats::writeCSV(std::string filepath, std::string label)
+{
+    // Appends a summary row (and a header if the file is new). Returns if written
+    bool isNew = !std::ifstream(filepath).good();
+    std::ofstream file(filepath, std::ios::app);
+    if (!file)
+    {
+        std::cout << "Unable to open " << filepath << " to write frame stats!" << std::endl;
+        return false;
+    }
+    Snapshot stats = snapshot();
+    if (isNew) {file << "label,frames,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches,total_frames,total_hitches\n";}
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    file << label << ',' << stats.frames << ',' << stats.mean << ',' << stats.p50 << ',' << stats.p95 << ',' << stats.p99 << ',' << stats.max
+        << ',' << stats.hitches << ',' << stats.totalFrames << ',' << stats.totalHitches << '\n';
+    return (bool)file;
+}
+
+bool FrameStats::writeJSON(std::string filepath, std::string label)
+{
+    // Writes the summary, the non-empty histogram buckets (by their lower edge in ms), and the remembered frames oldest first
+    std::ofstream file(filepath);
+    if (!file)
+    {
+        std::cout << "Unable to open " << filepath << " to write frame stats!" << std::endl;
+        return false;
+    }
+    std::string escaped;
+    for (char c : label)
+    {
+        if (c == '"' || c == '\\') {escaped += '\\';}
+        escaped += c;
+    }
+    Snapshot stats = snapshot();
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    file << "{\n  \"label\": \"" << escaped << "\",\n";
+    file << "  \"frames\": " << stats.frames << ",\n  \"mean_ms\": " << stats.mean << ",\n  \"p50_ms\": " << stats.p50 << ",\n  \"p95_ms\": " << stats.p95
+        << ",\n  \"p99_ms\": " << stats.p99 << ",\n  \"max_ms\": " << stats.max << ",\n  \"hitches\": " << stats.hitches
+        << ",\n  \"total_frames\": " << stats.totalFrames << ",\n  \"total_hitches\": " << stats.totalHitches << ",\n";
+    file << "  \"histogram\": [";
+    bool first = true;
+    for (int bucket = 0; bucket < BUCKETS; bucket++)
+    {
+        if (histogram[bucket] == 0) {continue;}
+        file << (first ? "" : ", ") << "[" << bucketMiddle(bucket) / pow(2.0, 1.0 / 32.0) << ", " << histogram[bucket] << "]";
+        first = false;
+    }
+    file << "],\n  \"frame_ms\": [";
+    int oldest = (frames == (int)ring.size()) ? next : 0;
+    for (int i = 0; i < frames; i++) {file << (i ? ", " : "") << ring[(oldest + i) % ring.size()].milliseconds;}
+    file << "]\n}\n";
+    return (bool)file;
+}
+
+int FrameStats::bucketAt(double percent)
+{
+    // The histogram bucket percent% of remembered frames are in or under
+    int wanted = std::max(1, (int)ceil(frames * std::min(100.0, std::max(0.0, percent)) / 100.0));
+    int seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++)
+    {
+        seen += histogram[bucket];
+        if (seen >= wanted) {return bucket;}
+    }
+    return BUCKETS - 1;
+}
+
+int FrameStats::bucketOf(double milliseconds)
+{
+    // Which histogram bucket a time goes in. Bucket 0 also holds everything under 0.1ms, the last everything too long for the rest
+    if (milliseconds <= 0.1) {return 0;}
+    return std::min(BUCKETS - 1, (int)(log2(milliseconds / 0.1) * 16.0));
+}
+
+double FrameStats::bucketMiddle(int bucket)
+{
+    // The time in the (geometric) middle of a bucket
+    return 0.1 * pow(2.0, (bucket + 0.5) / 16.0);
+}
+
+inline std::string canonicalPath(std::string filepath)
+{
+    // Returns the absolute path with "." and ".." (and on POSIX, symlinks) resolved, so one file always gets one name. Used as a cache key
+    // A path that can't be resolved is returned as given. Opening it will fail and say why
+#ifdef _WIN32
+    char full[_MAX_PATH];
+    if (_fullpath(full, filepath.c_str(), _MAX_PATH) != NULL) {filepath = full;}
+#else
+    char* full = realpath(filepath.c_str(), NULL);
+    if (full != NULL)
+    {
+        filepath = full;
+        free(full);
+    }
+#endif
+    return filepath;
+}
+
+class TextureCache
+{
+    // Textures loaded by SDL::loadSharedTexture(), keyed by canonical path and the scale quality hint they were made with, so each image is decoded and uploaded once
+    // Handles are refcounted. The cache keeps a reference of its own, so a texture stays loaded after its last handle goes, until purge() or the budget unloads it
+    // Only textures nothing else holds a handle to are ever unloaded, least recently used first
+public:
+    // Functions
+    inline TextureCache() : alive(new bool(true)) {}
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+    inline static std::string keyFor(std::string filepath); // The canonical path plus the current SDL_HINT_RENDER_SCALE_QUALITY
+    inline std::shared_ptr<SDL_Texture> find(const std::string& key); // The cached texture for key, or an empty handle
+    inline std::shared_ptr<SDL_Texture> add(const std::string& key, SDL_Texture* texture); // Takes ownership of texture and returns a handle to it
+    inline int purge(); // Unloads every texture nothing holds a handle to. Returns how many were unloaded
+    inline void clear(); // Unloads everything and stops outstanding handles destroying their textures. The renderer must be destroyed (which frees them) right after
+    inline void setBudget(size_t bytes); // Unloads unheld textures, oldest use first, whenever the estimate is over bytes. 0 means no limit
+    inline size_t budget() {return budgetBytes;}
+    inline size_t bytes() {return totalBytes;} // Estimated texture memory of everything cached (width * height * bytes per pixel)
+    inline int size() {return entries.size();} // How many textures are cached
+private:
+    // Types
+    struct Entry {
+        std::shared_ptr<SDL_Texture> texture; // The cache's own reference. Unheld when use_count() is 1
+        size_t bytes;
+        std::list<std::string>::iterator use; // Where this is in recent
+    };
+    // Functions
+    inline void evict(); // Unloads unheld textures, oldest use first, until under budget (or none are left to unload)
+    inline void unload(std::unordered_map<std::string, Entry>::iterator entry);
+    // Variables
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> recent; // Keys, most recently used first
+    size_t budgetBytes = 0;
+    size_t totalBytes = 0;
+    std::shared_ptr<bool> alive; // Shared with every deleter. False once clear() has handed the textures over to SDL_DestroyRenderer
+};
+
+std::string TextureCache::keyFor(std::string filepath)
+{
+    // The canonical path (so "a/../b.png" and "b.png" are one entry) plus the scale quality hint, since that's baked into a texture when it's made
+    const char* quality = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+    return canonicalPath(filepath) + '\n' + (quality != NULL ? quality : "0");
+}
+
+std::shared_ptr<SDL_Texture> TextureCache::find(const std::string& key)
+{
+    // The cached texture for key, marked as just used, or an empty handle
+    std::unordered_map<std::string, Entry>::iterator entry = entries.find(key);
+    if (entry == entries.end()) {return std::shared_ptr<SDL_Texture>();}
+    recent.splice(recent.begin(), recent, entry->second.use);
+    return entry->second.texture;
+}
+
+std::shared_ptr<SDL_Texture> TextureCache::add(const std::string& key, SDL_Texture* texture)
+{
+    // Takes ownership of texture, caches it under key (replacing anything there) and returns a handle to it
+    std::unordered_map<std::string, Entry>::iterator old = entries.find(key);
+    if (old != entries.end()) {unload(old);}
+    std::shared_ptr<bool> cacheAlive = alive;
+    Entry entry;
+    entry.texture = std::shared_ptr<SDL_Texture>(texture, [cacheAlive](SDL_Texture* texture) {if (*cacheAlive) {SDL_DestroyTexture(texture);}});
+    Uint32 format = 0;
+    int width = 0, height = 0;
+    SDL_QueryTexture(texture, &format, NULL, &width, &height);
+    entry.bytes = (size_t)width * height * std::max(1, (int)SDL_BYTESPERPIXEL(format));
+    recent.push_front(key);
+    entry.use = recent.begin();
+    totalBytes += entry.bytes;
+    std::shared_ptr<SDL_Texture> handle = entry.texture;
+    entries[key] = entry;
+    evict();
+    return handle;
+}
+
+int TextureCache::purge()
+{
+    // Unloads every texture nothing holds a handle to
+    int unloaded = 0;
+    for (std::unordered_map<std::string, Entry>::iterator entry = entries.begin(); entry != entries.end();)
+    {
+        std::unordered_map<std::string, Entry>::iterator current = entry++;
+        if (current->second.texture.use_count() == 1)
+        {
+            unload(current);
+            unloaded++;
+        }
+    }
+    return unloaded;
+}
+
+void TextureCache::clear()
+{
+    // Unloads everything. Handles still out there become plain pointers that won't destroy anything, as SDL_DestroyRenderer frees their textures
+    entries.clear();
+    recent.clear();
+    totalBytes = 0;
+    *alive = false;
+}
+
+void TextureCache::setBudget(size_t bytes)
+{
+    budgetBytes = bytes;
+    evict();
+}
+
+void TextureCache::evict()
+{
+    // Unloads unheld textures from the least recently used end until under budget. Held ones are skipped, so the total can stay over
+    if (budgetBytes == 0) {return;}
+    std::list<std::string>::iterator use = recent.end();
+    while (totalBytes > budgetBytes && use != recent.begin())
+    {
+        --use;
+        std::unordered_map<std::string, Entry>::iterator entry = entries.find(*use);
+        if (entry->second.texture.use_count() == 1)
+        {
+            use = recent.erase(use); // Now the older neighbour, already checked. The next --use lands on the newer one
+            totalBytes -= entry->second.bytes;
+            entries.erase(entry);
+        }
+    }
+}
+
+void TextureCache::unload(std::unordered_map<std::string, Entry>::iterator entry)
+{
+    recent.erase(entry->second.use);
+    totalBytes -= entry->second.bytes;
+    entries.erase(entry);
+}
+
 class SDL
 {
 public:
@@ -74,6 +490,12 @@ public:
     typedef std::chrono::high_resolution_clock clock;
     typedef std::chrono::duration<float, std::milli> duration;
     clock::time_point lastTick = clock::now(); // Used as a log point for FPS calculation
+    bool sleepWhileWaiting = true; // Whether FPSlog() sleeps through most of the wait (near-zero CPU) instead of spinning the whole time
+    double napMean = 1.0; // How long a 1ms sleep really takes on this machine, in milliseconds. Measured by FPSinit(), then kept up by FPSwait()
+    double napVariance = 1.0; // How much that varies
+    double napThreshold = 4.0; // FPSwait() stops sleeping once less than this is left. At least napMean plus 3 standard deviations, and jumps straight up to any nap longer than it
+    FrameStats frameStats; // Every frame time FPSlog() or FPSdelta() measures. See FrameStats
+    TextureCache textureCache; // Every texture loadSharedTexture() has loaded. See TextureCache
     bool windowed = true; // Whether this sdl instance is fullscreen or not
     int fullscreenWidth; // The width of the screen when fullscreen. Used for positioning things
     int fullscreenHeight; // ^^^
@@ -83,11 +505,13 @@ public:
     inline void clear(); // clears the screen
     inline void update(); // updates the screen (use SDL_RenderCopy in between)
     inline SDL_Texture* loadTexture(std::string filepath); // Loads the given filepath as an optimized texture
+    inline std::shared_ptr<SDL_Texture> loadSharedTexture(std::string filepath); // The same, but cached: a file is only loaded once. Drop the handle instead of destroying the texture
     inline SDL_Surface* loadSurface(std::string filepath); // Loads and returns a surface from a filepath
     inline SDL_Texture* newBlankTexture(int width, int height); // Creates and returns a new, optimized, blank texture of the given size
     inline SDL_Texture* newAntialiasedTexture(int width, int height); // Creates and return a new, optimized, blank, antialiased texture of given size
     inline SDL_Texture* multiplyTextureSize(SDL_Texture* sourceTexture, int scale, bool destructive = false); // Returns a new texture, scaled by the given constant
     inline void FPSinit(double framesPerSecond); // Starts the FPS submodule and caps framerate at a given number
+    inline void FPSwait(); // Waits until msPerFrame has passed since the last FPSlog()
     inline void FPSlog(); // Pauses the game until a given framerate is reached
     inline void FPSlog(double& FPS); // ^ plus stores FPS into passed variable
     inline void FPSdelta(); // Updates the deltatime variable but does NOT cap framerate
@@ -116,6 +540,7 @@ SDL::SDL(std::string title, int width, int height)
 
 SDL::~SDL()
 {
+    textureCache.clear(); // Before the renderer, which frees any textures still handed out
     SDL_DestroyWindow(window);
     SDL_DestroyRenderer(renderer);
     //SDL_FreeSurface(surface);
@@ -125,6 +550,7 @@ SDL::~SDL()
 
 SDL_Texture* SDL::loadTexture(std::string filepath)
 {
+    SDL_PROFILE_ZONE("SDL::loadTexture");
     SDL_Surface* loadedSurface = IMG_Load(filepath.c_str());
     if (loadedSurface == NULL)
     {
@@ -135,6 +561,17 @@ SDL_Texture* SDL::loadTexture(std::string filepath)
     return newTexture;
 }
 
+std::shared_ptr<SDL_Texture> SDL::loadSharedTexture(std::string filepath)
+{
+    // Returns the cached texture if this file has been loaded (with the current scale quality), and only loads it otherwise
+    std::string key = TextureCache::keyFor(filepath);
+    std::shared_ptr<SDL_Texture> texture = textureCache.find(key);
+    if (texture) {return texture;}
+    SDL_Texture* loaded = loadTexture(filepath);
+    if (loaded == NULL) {return texture;} // Empty. loadTexture() already said why
+    return textureCache.add(key, loaded);
+}
+
 SDL_Surface* SDL::loadSurface(std::string filepath)
 {
     //Load image at specified path
@@ -206,6 +643,7 @@ SDL_Texture* SDL::multiplyTextureSize(SDL_Texture* sourceTexture, int scale, boo
 
 void SDL::clear()
 {
+    SDL_PROFILE_ZONE("SDL::clear");
     SDL_RenderClear(renderer);
 
     // Old surface rendering things
@@ -217,6 +655,7 @@ void SDL::clear()
 
 void SDL::update()
 {
+    SDL_PROFILE_ZONE("SDL::update");
     SDL_RenderPresent(renderer);
 }
 
@@ -224,33 +663,73 @@ void SDL::FPSinit(double framesPerSecond)
 {
     // Calculate the amount of msPerFrame based on the given max framerate
     msPerFrame = 1000.0 / framesPerSecond;
+    // Time a few naps, so FPSwait() knows the OS timer from the first frame (about 1ms on Linux and macOS, ~15.6ms on a default Windows timer)
+    if (sleepWhileWaiting)
+    {
+        const int naps = 5;
+        double times[naps];
+        double sum = 0.0;
+        double longest = 0.0;
+        for (int i = 0; i < naps; i++)
+        {
+            clock::time_point before = clock::now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            times[i] = duration(clock::now() - before).count();
+            sum += times[i];
+            longest = std::max(longest, times[i]);
+        }
+        napMean = sum / naps;
+        napVariance = 0.0;
+        for (int i = 0; i < naps; i++) {napVariance += (times[i] - napMean) * (times[i] - napMean) / naps;}
+        napThreshold = std::max(longest, napMean + 3.0 * sqrt(napVariance));
+    }
     // Log the first tick value
     lastTick = clock::now();
 }
 
-void SDL::FPSlog()
+void SDL::FPSwait()
 {
-    // Cap the game to a given framerate (wait until the given msPerFrame is reached, then log the new ms count) using the more precise system
+    // Waits until msPerFrame has passed since the last FPSlog()
+    // Sleeps in 1ms naps while more than napThreshold is left, then spins the rest. Every nap is timed, so the idea of how long one
+    // takes follows the OS timer (about 1ms on Linux and macOS, up to ~16ms on a default Windows timer, where it just spins more)
+    SDL_PROFILE_ZONE("SDL::FPSwait");
+    if (sleepWhileWaiting)
+    {
+        while (msPerFrame - duration(clock::now() - lastTick).count() > napThreshold)
+        {
+            clock::time_point before = clock::now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            double nap = duration(clock::now() - before).count();
+            // Moving mean and variance, so it keeps up if the timer changes (power saving, another program changing the timer resolution, etc.)
+            double difference = nap - napMean;
+            napMean += difference * 0.05;
+            napVariance = 0.95 * (napVariance + 0.05 * difference * difference);
+            // A nap longer than the threshold raises it at once, so the next frames don't oversleep while the mean catches up. It only eases back down
+            double margin = napMean + 3.0 * sqrt(napVariance);
+            napThreshold = (nap > napThreshold) ? nap : std::max(margin, napThreshold + (margin - napThreshold) * 0.05);
+        }
+    }
     duration delta = clock::now() - lastTick;
     while(delta.count() < msPerFrame) {
         delta = clock::now() - lastTick;
     }
-    deltatime = delta.count();
-    lastTick = clock::now();
+}
+
+void SDL::FPSlog()
+{
+    // Cap the game to a given framerate (wait until the given msPerFrame is reached, then log the new ms count) using the more precise system
+    FPSwait();
+    clock::time_point now = clock::now();
+    deltatime = duration(now - lastTick).count();
+    lastTick = now;
+    frameStats.record(deltatime);
 }
 
 void SDL::FPSlog(double& FPS)
 {
     // This version also stores the FPS for use elsewhere
-
-    // Cap the game to a given framerate (wait until the given msPerFrame is reached, then log the new ms count) using the more precise system
-    duration delta = clock::now() - lastTick;
-    while(delta.count() < msPerFrame) {
-        delta = clock::now() - lastTick;
-    }
-    deltatime = delta.count();
+    FPSlog();
     FPS = 1000.0 / deltatime;
-    lastTick = clock::now();
 }
 
 inline void SDL::FPSdelta()
@@ -259,6 +738,7 @@ inline void SDL::FPSdelta()
     duration delta = clock::now() - lastTick;
     deltatime = delta.count();
     lastTick = clock::now();
+    frameStats.record(deltatime);
 }
 
 void SDL::toggleFullscreen()
@@ -359,6 +839,76 @@ SDL_Texture* mergeTexture(SDL_Texture* t1, int[2] t1_pos, SDL_Texture* t2, int[2
 
 /// Functions below can be used without an SDL instance ///
 
+inline int formatNumber(long long value, int decimals, char* buffer)
+{
+    // Writes value as text into buffer (needs room for 32 chars, not null-terminated) and returns the length. No allocation, no printf
+    // value is fixed-point: formatNumber(12345, 2, buffer) writes "123.45", formatNumber(-5, 2, buffer) writes "-0.05"
+    if (decimals < 0) {decimals = 0;}
+    if (decimals > 18) {decimals = 18;}
+    char reversed[32];
+    int length = 0;
+    unsigned long long magnitude = (value < 0) ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    // Digits come out lowest first, so build backwards
+    for (int digit = 0; magnitude > 0 || digit <= decimals; digit++)
+    {
+        if (digit == decimals && decimals > 0) {reversed[length++] = '.';}
+        reversed[length++] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    }
+    if (value < 0) {reversed[length++] = '-';}
+    for (int i = 0; i < length; i++) {buffer[i] = reversed[length - 1 - i];}
+    return length;
+}
+
+class NumberStrip
+{
+    // A number as indices into a strip of the only characters formatNumber writes, plus room for one quad per character
+    // Used by the fast number displays, which look each strip character up in their font once and then never format or allocate again
+public:
+    // Functions
+    NumberStrip()
+    {
+        // Every quad is two triangles in the same order, so the indices never change
+        for (int i = 0; i < MAX_GLYPHS; i++)
+        {
+            int indexList[6] = {i * 4, i * 4 + 1, i * 4 + 2, i * 4, i * 4 + 2, i * 4 + 3};
+            for (int j = 0; j < 6; j++) {indices[i * 6 + j] = indexList[j];}
+        }
+    }
+    static char character(int index) {return "0123456789-."[index];} // The strip character at index, 0 to SIZE - 1
+    static long long roundFixed(double value, int decimals)
+    {
+        // value rounded to the given number of decimals, as a fixed-point value for setFixed
+        double scale = 1.0;
+        for (int i = 0; i < decimals; i++) {scale *= 10.0;}
+        double scaled = value * scale;
+        return (long long)(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5);
+    }
+    void setFixed(long long value, int decimals)
+    {
+        // Fills strip and length with a fixed-point value: setFixed(12345, 2) holds "123.45"
+        char characters[MAX_GLYPHS];
+        length = formatNumber(value, decimals, characters);
+        for (int i = 0; i < length; i++) {strip[i] = (characters[i] == '-') ? 10 : ((characters[i] == '.') ? 11 : characters[i] - '0');}
+    }
+    void setQuad(int quad, float left, float top, float right, float bottom, float u0, float v0, float u1, float v1, SDL_Color color)
+    {
+        // Fills the four vertices of one quad, clockwise from the top left
+        SDL_Vertex* corners = vertices + quad * 4;
+        corners[0] = {{left, top}, color, {u0, v0}};
+        corners[1] = {{right, top}, color, {u1, v0}};
+        corners[2] = {{right, bottom}, color, {u1, v1}};
+        corners[3] = {{left, bottom}, color, {u0, v1}};
+    }
+    // Variables
+    static const int SIZE = 12; // How many characters are in the strip
+    static const int MAX_GLYPHS = 32; // formatNumber never writes more than this
+    int strip[MAX_GLYPHS]; // The current number, as strip indices
+    int length = 0;
+    SDL_Vertex vertices[MAX_GLYPHS * 4];
+    int indices[MAX_GLYPHS * 6];
+};
+
 inline Uint32 getPixel(SDL_Surface *surface, int x, int y)
 {
     int bpp = surface->format->BytesPerPixel;
@@ -484,4 +1034,149 @@ inline void SDL_DrawEllipse(SDL_Renderer* r, int x0, int y0, int radiusX, int ra
     }
 }
 
+/// Shared worker threads for CPU-heavy work (large text blocks, animation math, ...) ///
+
+class WorkerPool
+{
+    // A small fixed set of worker threads. Jobs must not touch the renderer; SDL rendering stays on the main thread
+public:
+    // Functions
+    inline WorkerPool(int threadCount = 0); // 0 makes one worker per extra CPU core
+    inline ~WorkerPool();
+    inline int size() {return workers.size();} // The number of worker threads (not counting the calling thread)
+    inline void run(std::function<void()> job); // Queues a job to run on any worker and returns immediately
+    template <typename Job>
+    inline void parallelFor(int count, const Job& job); // Runs job(0) to job(count - 1) across the workers AND the calling thread. Returns once all are done. Doesn't allocate
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+private:
+    // Types
+    struct Batch
+    {
+        // One parallelFor() call. Lives on the caller's stack, and helpers only touch it while the caller is still waiting for them
+        void (*call)(const void* job, int index); // Calls the caller's job, whatever type it is
+        const void* job;
+        int count;
+        std::atomic<int> next{0}; // The next unclaimed index
+        int helpers = 0; // How many workers should join in
+        int joined = 0; // How many have (guarded by jobsMutex, like active)
+        int active = 0; // How many are still working on it
+        void work() {for (int i = next++; i < count; i = next++) {call(job, i);}}
+    };
+    // Functions
+    inline void workerLoop();
+    template <typename Job>
+    static void callJob(const void* job, int index) {(*static_cast<const Job*>(job))(index);}
+    // Variables
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::vector<Batch*> batches; // parallelFor() calls still wanting helpers. Taken before queued jobs, since their callers are waiting
+    std::mutex jobsMutex;
+    std::condition_variable jobsWaiting;
+    std::condition_variable batchFinished; // A helper left a batch
+    bool stopping = false;
+};
+
+WorkerPool::WorkerPool(int threadCount)
+{
+    if (threadCount <= 0) {threadCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);}
+    for (int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    // Finishes any queued jobs, then joins every worker
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping = true;
+    }
+    jobsWaiting.notify_all();
+    for (std::thread& worker : workers) {worker.join();}
+}
+
+void WorkerPool::run(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.push_back(std::move(job));
+    }
+    jobsWaiting.notify_one();
+}
+
+template <typename Job>
+void WorkerPool::parallelFor(int count, const Job& job)
+{
+    // Every thread (workers + caller) grabs the next unclaimed index until none are left, so uneven jobs still balance out
+    // The batch and job stay on this stack: helpers find the batch in batches, and this waits for every helper to leave it before returning
+    // Workers busy with queued jobs never hold this up. Once every index is claimed, the batch stops taking helpers
+    Batch batch;
+    batch.call = &callJob<Job>;
+    batch.job = &job;
+    batch.count = count;
+    batch.helpers = std::min(count - 1, size());
+    if (batch.helpers > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            batches.push_back(&batch); // Keeps its capacity, so this only allocates the first time
+        }
+        if (batch.helpers == 1) {jobsWaiting.notify_one();}
+        else {jobsWaiting.notify_all();}
+    }
+    batch.work();
+    if (batch.helpers == 0) {return;}
+    std::unique_lock<std::mutex> lock(jobsMutex);
+    std::vector<Batch*>::iterator waiting = std::find(batches.begin(), batches.end(), &batch);
+    if (waiting != batches.end()) {batches.erase(waiting);} // Every index is claimed, so late helpers have nothing to do
+    batchFinished.wait(lock, [&batch]() {return batch.active == 0;});
+}
+
+void WorkerPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        Batch* batch = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobsWaiting.wait(lock, [this]() {return stopping || !jobs.empty() || !batches.empty();});
+            if (!batches.empty())
+            {
+                // Help with a parallelFor() first, since its caller is waiting
+                batch = batches.front();
+                batch->active++;
+                if (++batch->joined >= batch->helpers) {batches.erase(batches.begin());}
+            }
+            else if (jobs.empty()) {return;} // Stopping, and nothing left to do
+            else
+            {
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+        }
+        if (batch != nullptr)
+        {
+            {
+                SDL_PROFILE_ZONE("WorkerPool parallelFor");
+                batch->work();
+            }
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            if (--batch->active == 0) {batchFinished.notify_all();} // The caller may return (and the batch go away) as soon as this unlocks
+            continue;
+        }
+        SDL_PROFILE_ZONE("WorkerPool job");
+        job();
+    }
+}
+
+inline WorkerPool& sharedWorkerPool()
+{
+    // The process-wide pool used by the other utilities, made on first use
+    static WorkerPool pool;
+    return pool;
+}
+
 #endif // SDL_WRAPPER_H_INCLUDED